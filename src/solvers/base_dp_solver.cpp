@@ -11,33 +11,45 @@ Graph BaseDPSolver::solve() {
     std::cout << "VALUE " << result << std::endl;
     backtrack(0, 1, 0);
     for (auto edge : resultEdges) {
-        std::cout << edge.first + 1 << " " << edge.second + 1 << std::endl;
+        for (auto original : graph.expandEdge(edge)) {
+            std::cout << original.first + 1 << " " << original.second + 1 << std::endl;
+        }
     }
 
     return Graph();
 }
 
+void BaseDPSolver::setJoinEngine(JoinEngine engine) {
+    joinEngine = engine;
+}
+
 unsigned BaseDPSolver::solveInstance(int treeNode, unsigned int subset, uint64_t partition) {
-    if (dpCache[treeNode][subset].count(partition) != 0) {
-        return dpCache[treeNode][subset][partition];
+    auto cached = dpCache[treeNode][subset].find(partition);
+    if (cached != nullptr) {
+        return cached->cost;
     }
 
     TreeDecomposition::Node node = decomposition.getNodeAt(treeNode);
     // printDPState(node, treeNode, subset, partition);
 
     unsigned result;
+    stateBacktrack bt = {{-1, 0, 0}, {-1, 0, 0}};
     switch (node.type) {
         case TreeDecomposition::INTRO:
-            result = resolveIntroNode(node, treeNode, subset, partition);
+            result = resolveIntroNode(node, treeNode, subset, partition, bt);
             break;
         case TreeDecomposition::FORGET:
-            result = resolveForgetNode(node, treeNode, subset, partition);
+            result = resolveForgetNode(node, treeNode, subset, partition, bt);
             break;
         case TreeDecomposition::JOIN:
-            result = resolveJoinNode(node, treeNode, subset, partition);
+            if (joinEngine == JoinEngine::FORWARD) {
+                resolveJoinSubset(node, treeNode, subset);
+                return dpCache[treeNode][subset].find(partition)->cost;
+            }
+            result = resolveJoinNode(node, treeNode, subset, partition, bt);
             break;
         case TreeDecomposition::INTRO_EDGE:
-            result = resolveEdgeNode(node, treeNode, subset, partition);
+            result = resolveEdgeNode(node, treeNode, subset, partition, bt);
             break;
         case TreeDecomposition::LEAF:
             result = resolveLeafNode(subset);
@@ -47,49 +59,52 @@ unsigned BaseDPSolver::solveInstance(int treeNode, unsigned int subset, uint64_t
             exit(1);
     }
 
-    dpCache[treeNode][subset][partition] = result;
+    dpCache[treeNode][subset].improve(partition, result)->handle = bt;
     return result;
 }
 
 void BaseDPSolver::backtrack(int treeNode, int subset, uint64_t partition) {
-    TreeDecomposition::Node node = decomposition.getNodeAt(treeNode);
-    // printDPState(node, treeNode, subset, partition);
+    // explicit stack of states to visit, the nice tree can be far deeper than the call stack allows
+    std::vector<backtrackEntry> stack = {{treeNode, (unsigned)subset, partition}};
+    while (!stack.empty()) {
+        backtrackEntry state = stack.back();
+        stack.pop_back();
 
-    if (node.type == TreeDecomposition::LEAF) {
-        return;
-    }
-    std::vector<uint64_t> next = dpBacktrack[treeNode][subset][partition];
-    switch (node.type) {
-        case TreeDecomposition::INTRO:
-        case TreeDecomposition::FORGET:
-            backtrack((int)next[0], (int)next[1], next[2]);
-            break;
+        TreeDecomposition::Node node = decomposition.getNodeAt(state.nodeId);
+        // printDPState(node, state.nodeId, state.subset, state.partition);
 
-        case TreeDecomposition::JOIN:
-            backtrack((int)next[0], (int)next[1], next[2]);
-            backtrack((int)next[3], (int)next[4], next[5]);
-            break;
-
-        case TreeDecomposition::INTRO_EDGE:
-            if (next[2] != partition) {
-                resultEdges.push_back(node.associatedEdge);
-            }
-            backtrack((int)next[0], (int)next[1], next[2]);
-            break;
-
-        case TreeDecomposition::LEAF:
-            break;
-
-        default:
-            std::cerr << "Error, decomposition not nice!" << std::endl;
-            exit(1);
+        if (node.type == TreeDecomposition::LEAF) {
+            continue;
+        }
+        const stateBacktrack &bt = dpCache[state.nodeId][state.subset].handleOf(state.partition);
+        switch (node.type) {
+            case TreeDecomposition::INTRO:
+            case TreeDecomposition::FORGET:
+                stack.push_back(bt.next);
+                break;
+
+            case TreeDecomposition::JOIN:
+                stack.push_back(bt.join);
+                stack.push_back(bt.next);
+                break;
+
+            case TreeDecomposition::INTRO_EDGE:
+                if (bt.next.partition != state.partition) {
+                    resultEdges.push_back(node.associatedEdge);
+                }
+                stack.push_back(bt.next);
+                break;
+
+            default:
+                std::cerr << "Error, decomposition not nice!" << std::endl;
+                exit(1);
+        }
     }
 }
 
 void BaseDPSolver::initializeDP() {
     unsigned treeNodes = decomposition.getNodeCount();
     dpCache.resize(treeNodes);
-    dpBacktrack.resize(treeNodes);
     for (unsigned i = 0; i < treeNodes; ++i) {
         auto bagSize = decomposition.getBagOf(i).size();
         // 64b variable insufficient for partitions
@@ -98,41 +113,31 @@ void BaseDPSolver::initializeDP() {
         }
 
         dpCache[i].resize(1u << bagSize);
-        dpBacktrack[i].resize(1u << bagSize);
     }
     resultEdges.clear();
 }
 
-unsigned BaseDPSolver::resolveIntroNode(TreeDecomposition::Node &node,
-                                   int treeNode, unsigned subset, uint64_t partition) {
+unsigned BaseDPSolver::resolveIntroNode(TreeDecomposition::Node &node, int treeNode, unsigned subset,
+                                        uint64_t partition, stateBacktrack &bt) {
     // get child id
-    int child = 0;
-    for (auto adj : node.adjacent) {
-        if (adj < treeNode) {
-            continue;
-        }
-        child = adj;
-    }
+    int child = node.index.children[0];
 
     // process introduced node
     int introduced = node.associatedNode;
-    unsigned idOfIntro = 0;
-    while (node.bag[idOfIntro] != introduced) {
-        idOfIntro++;
-    }
+    unsigned idOfIntro = node.index.position;
 
     // check if we are introducing the global terminal
     if (introduced == globalTerminal) {
-        dpBacktrack[treeNode][subset][partition] = {child, subset, partition};
+        bt.next = {child, subset, partition};
         return solveInstance(child, subset, partition);
     }
 
-    std::vector<char> vParts = partitionToVec((int)node.bag.size(), partition);
     // if the element is in used subset
     if ((subset & (1u << idOfIntro)) != 0) {
         // has to be alone in its partition
-        for (unsigned i = 0; i < vParts.size(); ++i) {
-            if (i != idOfIntro && vParts[i] == vParts[idOfIntro]) {
+        int introducedComponent = getComponentAt(partition, idOfIntro);
+        for (unsigned i = 0; i < node.bag.size(); ++i) {
+            if (i != idOfIntro && isInSubset(i, subset) && getComponentAt(partition, i) == introducedComponent) {
                 return INFTY;
             }
         }
@@ -145,48 +150,37 @@ unsigned BaseDPSolver::resolveIntroNode(TreeDecomposition::Node &node,
 
     // prepare new partitions
     unsigned newMask = maskWithoutElement(subset, idOfIntro, (int)node.bag.size());
-    uint64_t newPartition = partitionWithoutElement(vParts, idOfIntro, newMask);
+    uint64_t newPartition = canonizePartition(eraseComponentAt(partition, idOfIntro, (unsigned)node.bag.size()),
+                                              newMask, (unsigned)node.bag.size() - 1);
 
     // get the solution from the child
     unsigned result = solveInstance(child, newMask, newPartition);
-    dpBacktrack[treeNode][subset][partition] = {child, newMask, newPartition};
+    bt.next = {child, newMask, newPartition};
     return result;
 }
 
-unsigned BaseDPSolver::resolveForgetNode(TreeDecomposition::Node &node,
-                                         int treeNode, unsigned int subset, uint64_t partition) {
+unsigned BaseDPSolver::resolveForgetNode(TreeDecomposition::Node &node, int treeNode, unsigned int subset,
+                                         uint64_t partition, stateBacktrack &bt) {
     // get the singular child
-    int child = 0;
-    for (auto adj : node.adjacent) {
-        if (adj < treeNode) {
-            continue;
-        }
-        child = adj;
-    }
-    const TreeDecomposition::Node &childNode = decomposition.getNodeAt(child);
+    int child = node.index.children[0];
 
     // get id of the forgotten node in child
-    int forgotten = node.associatedNode, forgottenId = 0;
+    int forgotten = node.associatedNode, forgottenId = (int)node.index.position;
     if (forgotten == globalTerminal) {
-        dpBacktrack[treeNode][subset][partition] = {child, subset, partition};
+        bt.next = {child, subset, partition};
         return solveInstance(child, subset, partition);
     }
-    while (childNode.bag[forgottenId] != forgotten) {
-        forgottenId++;
-    }
 
     unsigned newMask, bestMask = 0;
     uint64_t newPartition = 0, bestPartition = 0;
     unsigned result = INFTY;
-    std::vector<char> vPartition = partitionToVec((int)node.bag.size(), partition),
-                      newVPartition;
+    auto size = (unsigned)node.bag.size();
 
     // case, where we didn't use the forgotten node
     if (!graph.isTerm(forgotten)) {
         newMask = maskWithElement(subset, (unsigned)forgottenId, 0, (int) node.bag.size());
-        newVPartition = vPartition;
-        newVPartition.insert(newVPartition.begin() + forgottenId, 0);
-        newPartition = vecToPartition(newVPartition, newMask);
+        newPartition = canonizePartition(insertComponentAt(partition, (unsigned)forgottenId, 0, size),
+                                         newMask, size + 1);
         result = solveInstance(child, newMask, newPartition);
 
         // keep track of the best solution for backtrack
@@ -196,11 +190,10 @@ unsigned BaseDPSolver::resolveForgetNode(TreeDecomposition::Node &node,
 
     // case, where we used the forgotten node
     newMask = maskWithElement(subset, (unsigned)forgottenId, 1, (int)node.bag.size());
-    int maxPartitionId = *std::max_element(vPartition.begin(), vPartition.end());
-    for (char part = 0; part < maxPartitionId + 1; part++) {
-        newVPartition = vPartition;
-        newVPartition.insert(newVPartition.begin() + forgottenId, part);
-        newPartition = vecToPartition(newVPartition, newMask);
+    int maxPartitionId = maxComponentIn(partition, size);
+    for (unsigned part = 0; part < (unsigned)maxPartitionId + 1; part++) {
+        newPartition = canonizePartition(insertComponentAt(partition, (unsigned)forgottenId, part, size),
+                                         newMask, size + 1);
 
         unsigned candidate = solveInstance(child, newMask, newPartition);
         if (result > candidate) {
@@ -210,20 +203,14 @@ unsigned BaseDPSolver::resolveForgetNode(TreeDecomposition::Node &node,
         }
     }
 
-    dpBacktrack[treeNode][subset][partition] = {child, bestMask, bestPartition};
+    bt.next = {child, bestMask, bestPartition};
     return result;
 }
 
-unsigned BaseDPSolver::resolveJoinNode(TreeDecomposition::Node &node,
-                                       int treeNode, unsigned int subset, uint64_t partition) {
+unsigned BaseDPSolver::resolveJoinNode(TreeDecomposition::Node &node, int treeNode, unsigned int subset,
+                                       uint64_t partition, stateBacktrack &bt) {
     // get children IDs
-    int children[2], childPtr = 0;
-    for (auto adj : node.adjacent) {
-        if (adj < treeNode) {
-            continue;
-        }
-        children[childPtr++] = adj;
-    }
+    const int *children = node.index.children;
 
     // find possible partitions
     auto bagSize = node.bag.size();
@@ -265,44 +252,54 @@ unsigned BaseDPSolver::resolveJoinNode(TreeDecomposition::Node &node,
     }
 
     // write backtrack info about both branches
-    dpBacktrack[treeNode][subset][partition] = {children[0], subset, bestP1,
-                                                children[1], subset, bestP2};
+    bt.next = {children[0], subset, bestP1};
+    bt.join = {children[1], subset, bestP2};
     return result;
 }
 
-unsigned BaseDPSolver::resolveEdgeNode(TreeDecomposition::Node &node,
-                                       int treeNode, unsigned int subset, uint64_t partition) {
-    // get both endpoints of the new edge
-    int intro1 = node.associatedEdge.first,
-        intro2 = node.associatedEdge.second;
-
-    // get both edge endpoint ids
-    unsigned end1id = 0, end2id = 0;
-    while (node.bag[end1id] != intro1) {
-        end1id++;
+void BaseDPSolver::resolveJoinSubset(TreeDecomposition::Node &node, int treeNode, unsigned int subset) {
+    // get children IDs
+    const int *children = node.index.children;
+
+    // every partition of the subset from both children, indexed by rank
+    auto members = (unsigned)__builtin_popcount(subset);
+    std::vector<unsigned> costs1(partitionCount(members)), costs2(partitionCount(members));
+    for (uint64_t rank = 0; rank < costs1.size(); rank++) {
+        uint64_t partition = expandPartition(unrankPartition(rank, members), subset);
+        costs1[rank] = solveInstance(children[0], subset, partition);
+        costs2[rank] = solveInstance(children[1], subset, partition);
     }
-    while (node.bag[end2id] != intro2) {
-        end2id++;
+
+    ForwardJoin join(costs1, costs2, members, INFTY);
+    join.compute();
+
+    // all parent states at once, unreachable ones included so they are not resolved again
+    for (uint64_t rank = 0; rank < costs1.size(); rank++) {
+        std::pair<uint64_t, uint64_t> choice = join.getChoice(rank);
+        uint64_t partition = expandPartition(unrankPartition(rank, members), subset);
+        stateBacktrack bt = {{children[0], subset, expandPartition(unrankPartition(choice.first, members), subset)},
+                             {children[1], subset, expandPartition(unrankPartition(choice.second, members), subset)}};
+        dpCache[treeNode][subset].improve(partition, join.getResult()[rank])->handle = bt;
     }
+}
+
+unsigned BaseDPSolver::resolveEdgeNode(TreeDecomposition::Node &node, int treeNode, unsigned int subset,
+                                       uint64_t partition, stateBacktrack &bt) {
+    // get both edge endpoint ids
+    unsigned end1id = node.index.edgePositions[0], end2id = node.index.edgePositions[1];
 
     // find the singular child
-    int child = 0;
-    for (auto adj : node.adjacent) {
-        if (adj < treeNode) {
-            continue;
-        }
-        child = adj;
-    }
+    int child = node.index.children[0];
 
     // if one of them is not in the selected subset
     if (!isInSubset(end1id, subset) || !isInSubset(end2id, subset)) {
-        dpBacktrack[treeNode][subset][partition] = {child, subset, partition};
+        bt.next = {child, subset, partition};
         return solveInstance(child, subset, partition);
     }
 
     // if they are in separate partitions
     if (getComponentAt(partition, end1id) != getComponentAt(partition, end2id)) {
-        dpBacktrack[treeNode][subset][partition] = {child, subset, partition};
+        bt.next = {child, subset, partition};
         return solveInstance(child, subset, partition);
     }
 
@@ -311,33 +308,32 @@ unsigned BaseDPSolver::resolveEdgeNode(TreeDecomposition::Node &node,
     uint64_t bestPartition = partition;
 
     // setup variables for the cases where the edge is used
-    std::vector<char> vPartition = partitionToVec((int)node.bag.size(), partition);
-    int maxPartitionId = *std::max_element(vPartition.begin(), vPartition.end());
-    int edgeWeight = graph.getAdjacentOf(intro1).at(intro2);
+    int maxPartitionId = maxComponentIn(partition, (unsigned)node.bag.size());
+    int edgeWeight = (int)node.index.edgeWeight;
 
     // iterate over all possible partitions, where edge ends are disconnected
 
     std::vector<int> edgePartitionIds;
     for (unsigned i = 0; i < node.bag.size(); i++) {
-        if (vPartition[i] == vPartition[end1id] && isInSubset(i, subset)) {
+        if (getComponentAt(partition, i) == getComponentAt(partition, end1id) && isInSubset(i, subset)) {
             edgePartitionIds.push_back(i);
         }
     }
     auto edgePartitionSize = edgePartitionIds.size();
 
     for (unsigned option = 0; option < (1u << edgePartitionSize); option++) {
-        std::vector<char> newVPartition = vPartition;
+        uint64_t newPartition = partition;
         unsigned ctr = 0;
         for (auto id : edgePartitionIds) {
             if ((option & (1u << ctr++)) != 0) {
                 // set new separate partition
-                newVPartition[id] = (char)(maxPartitionId + 1);
+                setComponentAt(newPartition, id, (unsigned char)(maxPartitionId + 1));
             }
         }
-        if (newVPartition[end1id] == newVPartition[end2id]) {
+        if (getComponentAt(newPartition, end1id) == getComponentAt(newPartition, end2id)) {
             continue;
         }
-        uint64_t newPartition = vecToPartition(newVPartition, subset);
+        newPartition = canonizePartition(newPartition, subset, (unsigned)node.bag.size());
 
         unsigned candidate = solveInstance(child, subset, newPartition);
         if (result > candidate + edgeWeight) {
@@ -346,7 +342,7 @@ unsigned BaseDPSolver::resolveEdgeNode(TreeDecomposition::Node &node,
         }
     }
 
-    dpBacktrack[treeNode][subset][partition] = {child, subset, bestPartition};
+    bt.next = {child, subset, bestPartition};
     return result;
 }
 
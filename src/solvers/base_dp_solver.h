@@ -7,12 +7,13 @@
 #include <iostream>
 #include <map>
 #include <memory>
-#include <unordered_map>
 #include <vector>
 
 #include "solvers/solver.h"
+#include "structures/state_table.h"
 #include "structures/graph.h"
 #include "structures/tree_decomposition.h"
+#include "utility/forward_join.h"
 #include "utility/helpers.h"
 #include "utility/partitioner.h"
 #include "utility/partition_mergers.h"
@@ -21,6 +22,7 @@ class BaseDPSolver : public Solver {
 public:
     BaseDPSolver(const Graph &inputGraph, const TreeDecomposition &niceDecomposition)
             : Solver(inputGraph, niceDecomposition),
+              joinEngine(JoinEngine::REFINEMENTS),
               globalTerminal(-1) {
         INFTY = (UINT_MAX >> 1u) - 10;
         if (INFTY < inputGraph.getEdgeWeightSum()) {
@@ -31,27 +33,45 @@ public:
 
     Graph solve() override;
 
+    /**
+     * Refinements by default, they only touch the child states the requested parent needs. Forward
+     * fills in every parent state of the subset on the first request.
+     */
+    void setJoinEngine(JoinEngine engine);
+
 private:
+    struct backtrackEntry {
+        int nodeId;
+        unsigned subset;
+        uint64_t partition;
+    };
+
+    // child states a state comes from, join is only used by JOIN nodes
+    struct stateBacktrack {
+        backtrackEntry next, join;
+    };
+
     unsigned solveInstance(int treeNode, unsigned int subset, uint64_t partition);
     void backtrack(int treeNode, int subset, uint64_t partition);
     void initializeDP();
 
-    unsigned resolveIntroNode(TreeDecomposition::Node &node,
-                              int treeNode, unsigned subset, uint64_t partition);
-    unsigned resolveForgetNode(TreeDecomposition::Node &node,
-                               int treeNode, unsigned int subset, uint64_t partition);
-    unsigned resolveJoinNode(TreeDecomposition::Node &node,
-                             int treeNode, unsigned int subset, uint64_t partition);
-    unsigned resolveEdgeNode(TreeDecomposition::Node &node,
-                             int treeNode, unsigned int subset, uint64_t partition);
+    unsigned resolveIntroNode(TreeDecomposition::Node &node, int treeNode, unsigned subset,
+                              uint64_t partition, stateBacktrack &bt);
+    unsigned resolveForgetNode(TreeDecomposition::Node &node, int treeNode, unsigned int subset,
+                               uint64_t partition, stateBacktrack &bt);
+    unsigned resolveJoinNode(TreeDecomposition::Node &node, int treeNode, unsigned int subset,
+                             uint64_t partition, stateBacktrack &bt);
+    void resolveJoinSubset(TreeDecomposition::Node &node, int treeNode, unsigned int subset);
+    unsigned resolveEdgeNode(TreeDecomposition::Node &node, int treeNode, unsigned int subset,
+                             uint64_t partition, stateBacktrack &bt);
     unsigned resolveLeafNode(unsigned int subset);
 
     void printDPState(TreeDecomposition::Node &node,
                       int treeNode, unsigned int subset, uint64_t partition);
 
-    std::vector<std::vector<std::unordered_map<uint64_t, unsigned>>> dpCache;
-    std::vector<std::vector<std::unordered_map<uint64_t, std::vector<uint64_t>>>> dpBacktrack;
+    std::vector<std::vector<StateTable<stateBacktrack>>> dpCache;
     std::vector<std::pair<int, int>> resultEdges;
+    JoinEngine joinEngine;
     int globalTerminal;
     unsigned INFTY;
 
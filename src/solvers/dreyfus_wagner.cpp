@@ -7,152 +7,230 @@ Graph DreyfusWagner::solve() {
     unsigned k = (unsigned)terminals.size(), n = (unsigned)graph.getNodeCount();
 
     // intialize dynamic programming caches
-    dp = new unsigned*[1u << k];
-    dp_par = new unsigned*[1u << k];
-    for (int i = 0; i < (1 << k); i++) {
-        dp[i] = new unsigned[n];
-        for (unsigned j = 0; j < n; j++) {
-            dp[i][j] = i ? INFTY : 0;
-        }
-        dp_par[i] = new unsigned[n];
-    }
-    closed = new int[n];
-    parent = new int[n];
-    dist   = new unsigned[n];
+    allocateTable(k, n);
+    parent.resize(n);
+    dist.resize(n);
 
     // initial values of subsets only containing one terminal
     int enumerate = 0;
     for (auto i : terminals) {
-        dp[1u << enumerate][i] = 0;
+        at(1u << enumerate, (unsigned)i) = 0;
         enumerate++;
     }
 
-    // for all subsets of terminals
+    // subsets only depend on their proper subsets, so ones of the same size are independent
+    std::vector<std::vector<unsigned>> layers(k + 1);
     for (unsigned subset = 1; subset < (1u << k); subset++) {
-        unsigned most_sig = (1u << 31u) >> (unsigned)__builtin_clz(subset);
-        for (unsigned d = (subset - 1) & subset; d & most_sig; d = (d - 1) & subset) {
-            for (unsigned root = 0; root < n; root++) {
-                if (dp[subset][root] > dp[d][root] + dp[subset - d][root]) {
-                    dp[subset][root] = dp[d][root] + dp[subset - d][root];
-                    dp_par[subset][root] = d;
-                }
-            }
-        }
-
-        memset(closed, 0, sizeof(int)*n);
-        std::priority_queue<std::pair<unsigned, unsigned>, std::vector<std::pair<unsigned, unsigned>>,
-                std::greater<std::pair<unsigned, unsigned>>> dijkstra_q;
-        for (unsigned i = 0; i < n; i++) {
-            dijkstra_q.push({dp[subset][i], i});
-            dist[i] = dp[subset][i];
-        }
-        while (dijkstra_q.size() != 0) {
-            std::pair<unsigned, unsigned> curr = dijkstra_q.top();
-            dijkstra_q.pop();
-            if (closed[curr.second] != 0) {
-                continue;
-            }
-            closed[curr.second] = 1;
-            for (auto adj : graph.getAdjacentOf(curr.second)) {
-                if (closed[adj.first] != 0) {
-                    continue;
-                }
-                if (dist[adj.first] > curr.first + adj.second) {
-                    dist[adj.first] = curr.first + adj.second;
-                    dijkstra_q.push({dist[adj.first], adj.first});
-                }
-            }
-        }
+        layers[__builtin_popcount(subset)].push_back(subset);
+    }
 
-        for (unsigned i = 0; i < n; i++) {
-            dp[subset][i] = dist[i];
-        }
+    ThreadPool &pool = getPool();
+    workspaces.assign(pool.getThreadCount(),
+                      Workspace{std::vector<unsigned>(n), std::vector<int>(storePredecessors ? n : 0),
+                                ShortestPaths(queue)});
+    backtrackPaths = ShortestPaths(queue);
+    for (auto &layer : layers) {
+        pool.parallelFor(0, (unsigned)layer.size(), [&](unsigned idx) {
+            solveSubset(layer[idx], workspaces[ThreadPool::workerId()]);
+        });
     }
 
-    std::cout << "VALUE " << dp[(1u << k) - 1][terminals[0]] + graph.getPreselectedWeight() << std::endl;
+    std::cout << "VALUE " << at((1u << k) - 1, (unsigned)terminals[0]) + graph.getPreselectedWeight() << std::endl;
     std::vector<std::pair<int, int>> edges;
-    backtrack((1u << k) - 1, terminals[0], edges);
+    if (storePredecessors) {
+        backtrackStored((1u << k) - 1, terminals[0], edges);
+    } else {
+        backtrack((1u << k) - 1, terminals[0], edges);
+    }
     for (auto i : edges) {
-        std::cout << i.first + 1 << " " << i.second + 1 << std::endl;
+        for (auto original : graph.expandEdge(i)) {
+            std::cout << original.first + 1 << " " << original.second + 1 << std::endl;
+        }
     }
     for (auto i : graph.getPreselectedEdges()) {
         std::cout << i.first + 1 << " " << i.second + 1 << std::endl;
     }
 
+    releaseTable();
     return Graph();
 }
 
-void DreyfusWagner::backtrack(unsigned subset, int root, std::vector<std::pair<int, int>> &tree) {
-    if (__builtin_popcount(subset) == 1) {
-        memset(closed, 0, sizeof(int) * graph.getNodeCount());
-        std::priority_queue<std::pair<unsigned, unsigned>, std::vector<std::pair<unsigned, unsigned>>,
-                std::greater<std::pair<unsigned, unsigned>>> dijkstra_q;
-        for (int i = 0; i < graph.getNodeCount(); i++) {
-            dist[i] = INFTY;
-            parent[i] = -1;
-        }
+double DreyfusWagner::estimateWork(const Graph &graph) {
+    auto k = (double)graph.getTerminals().size(), n = (double)graph.getNodeCount(),
+            m = (double)graph.getEdgeCount();
+    return std::pow(3.0, k) * n + std::pow(2.0, k) * (m + n * std::log2(std::max(n, 2.0)));
+}
 
-        int from = graph.getTerminals()[__builtin_ffs(subset) - 1];
-        dist[from] = 0;
-        dijkstra_q.push({dist[from], from});
-        while (dijkstra_q.size()) {
-            std::pair<int, int> curr = dijkstra_q.top();
-            dijkstra_q.pop();
-            if (closed[curr.second]) continue;
-            closed[curr.second] = 1;
-            for (auto adj : graph.getAdjacentOf(curr.second)) {
-                if (closed[adj.first]) continue;
-                if (dist[adj.first] > (unsigned)curr.first + adj.second) {
-                    dist[adj.first] = (unsigned)curr.first + adj.second;
-                    parent[adj.first] = curr.second;
-                    dijkstra_q.push({dist[adj.first], adj.first});
-                }
-            }
+void DreyfusWagner::setLayout(Layout tableLayout) {
+    layout = tableLayout;
+}
+
+void DreyfusWagner::setQueue(ShortestPaths::Queue pathsQueue) {
+    queue = pathsQueue;
+}
+
+void DreyfusWagner::setStorePredecessors(bool store) {
+    storePredecessors = store;
+}
+
+void DreyfusWagner::allocateTable(unsigned k, unsigned n) {
+    size_t subsetCount = (size_t)1 << k;
+    size_t cells;
+    if (layout == Layout::SUBSET_MAJOR) {
+        // pad rows to whole cache lines, so every row starts aligned for the merge kernel
+        stride = (n + 15) & ~(size_t)15;
+        cells = subsetCount * stride;
+    } else {
+        stride = subsetCount;
+        cells = (size_t)n * stride;
+    }
+    size_t bytes = ((cells * sizeof(unsigned) + 63) & ~(size_t)63);
+    table.reset(static_cast<unsigned*>(std::aligned_alloc(64, bytes ? bytes : 64)));
+    if (!table) {
+        std::cerr << "Dreyfus-Wagner: cannot allocate " << bytes << " bytes for the dp table" << std::endl;
+        exit(1);
+    }
+    std::fill(table.get(), table.get() + cells, INFTY);
+    for (unsigned i = 0; i < n; i++) {
+        at(0, i) = 0;
+    }
+    if (storePredecessors) {
+        predecessors.assign(cells, -1);
+    }
+}
+
+void DreyfusWagner::releaseTable() {
+    table.reset();
+    std::vector<int>().swap(predecessors);
+    std::vector<int>().swap(parent);
+    std::vector<unsigned>().swap(dist);
+    std::vector<Workspace>().swap(workspaces);
+}
+
+void DreyfusWagner::solveSubset(unsigned subset, Workspace &workspace) {
+    unsigned n = (unsigned)graph.getNodeCount();
+    for (unsigned i = 0; i < n; i++) {
+        workspace.dist[i] = at(subset, i);
+    }
+    mergeSubset(subset, workspace.dist.data());
+
+    if (!storePredecessors) {
+        workspace.paths.relax(graph, workspace.dist.data(), nullptr, INFTY);
+        for (unsigned i = 0; i < n; i++) {
+            at(subset, i) = workspace.dist[i];
         }
+        return;
+    }
+
+    std::fill(workspace.parent.begin(), workspace.parent.end(), -1);
+    workspace.paths.relax(graph, workspace.dist.data(), workspace.parent.data(), INFTY);
+    for (unsigned i = 0; i < n; i++) {
+        at(subset, i) = workspace.dist[i];
+        predecessors[indexOf(subset, i)] = workspace.parent[i];
+    }
+}
 
-        int curr = root, prev = parent[curr];
-        while (prev != -1) {
-            tree.push_back({curr, prev});
-            curr = prev;
-            prev = parent[curr];
+void DreyfusWagner::mergeSubset(unsigned subset, unsigned *target) const {
+    unsigned n = (unsigned)graph.getNodeCount();
+    // every split is visited once, as the part containing the most significant bit
+    unsigned most_sig = (1u << 31u) >> (unsigned)__builtin_clz(subset);
+    if (layout == Layout::SUBSET_MAJOR) {
+        for (unsigned d = (subset - 1) & subset; d & most_sig; d = (d - 1) & subset) {
+            minPlus(target, table.get() + d * stride, table.get() + (subset - d) * stride, n);
         }
         return;
     }
+    for (unsigned i = 0; i < n; i++) {
+        const unsigned *row = table.get() + i * stride;
+        unsigned best = target[i];
+        for (unsigned d = (subset - 1) & subset; d & most_sig; d = (d - 1) & subset) {
+            best = std::min(best, row[d] + row[subset - d]);
+        }
+        target[i] = best;
+    }
+}
 
-    memset(closed, 0, sizeof(int) * graph.getNodeCount());
-    std::priority_queue<std::pair<unsigned, unsigned>, std::vector<std::pair<unsigned, unsigned>>,
-            std::greater<std::pair<unsigned, unsigned>>> dijkstra_q;
-    for (int i = 0; i < graph.getNodeCount(); i++) {
-        if (graph.isNodeErased(i)) {
-            continue;
+void DreyfusWagner::findSplits(unsigned subset, const unsigned *target, unsigned *splits) const {
+    unsigned n = (unsigned)graph.getNodeCount();
+    unsigned most_sig = (1u << 31u) >> (unsigned)__builtin_clz(subset);
+    if (layout == Layout::SUBSET_MAJOR) {
+        for (unsigned d = (subset - 1) & subset; d & most_sig; d = (d - 1) & subset) {
+            minPlusArgmin(target, table.get() + d * stride, table.get() + (subset - d) * stride, n, d, splits);
         }
-        dist[i] = dp[dp_par[subset][i]][i]
-                  + dp[subset - dp_par[subset][i]][i];
-        parent[i] = -1;
-        dijkstra_q.push({dist[i], i});
-    }
-    while (dijkstra_q.size()) {
-        std::pair<int, int> curr = dijkstra_q.top();
-        dijkstra_q.pop();
-        if (closed[curr.second]) continue;
-        closed[curr.second] = 1;
-        for (auto adj : graph.getAdjacentOf(curr.second)) {
-            if (closed[adj.first]) continue;
-            if (dist[adj.first] > (unsigned)curr.first + adj.second) {
-                dist[adj.first] = (unsigned)curr.first + adj.second;
-                parent[adj.first] = curr.second;
-                dijkstra_q.push({dist[adj.first], adj.first});
+        return;
+    }
+    for (unsigned i = 0; i < n; i++) {
+        const unsigned *row = table.get() + i * stride;
+        for (unsigned d = (subset - 1) & subset; d & most_sig; d = (d - 1) & subset) {
+            if (row[d] + row[subset - d] == target[i]) {
+                splits[i] = d;
+                break;
             }
         }
     }
+}
+
+void DreyfusWagner::backtrack(unsigned subset, int root, std::vector<std::pair<int, int>> &tree) {
+    if (__builtin_popcount(subset) == 1) {
+        std::fill(dist.begin(), dist.end(), INFTY);
+        std::fill(parent.begin(), parent.end(), -1);
+        dist[graph.getTerminals()[__builtin_ffs(subset) - 1]] = 0;
+        backtrackPaths.relax(graph, dist.data(), parent.data(), INFTY);
+        appendPath(root, tree);
+        return;
+    }
 
+    // recompute merged values of the subset before relaxation, and the splits attaining them
+    unsigned n = (unsigned)graph.getNodeCount();
+    std::vector<unsigned> splits(n, 0);
+    std::fill(dist.begin(), dist.end(), INFTY);
+    mergeSubset(subset, dist.data());
+    findSplits(subset, dist.data(), splits.data());
+
+    std::fill(parent.begin(), parent.end(), -1);
+    backtrackPaths.relax(graph, dist.data(), parent.data(), INFTY);
+
+    int curr = root;
+    while (parent[curr] != -1) {
+        curr = parent[curr];
+    }
+    appendPath(root, tree);
+
+    unsigned split = splits[curr];
+    backtrack(split, curr, tree);
+    backtrack(subset - split, curr, tree);
+}
+
+void DreyfusWagner::backtrackStored(unsigned subset, int root, std::vector<std::pair<int, int>> &tree) {
+    // walk the stored predecessors up to the node where the subset value was merged
+    int curr = root, prev = predecessors[indexOf(subset, (unsigned)root)];
+    while (prev != -1) {
+        tree.push_back({curr, prev});
+        curr = prev;
+        prev = predecessors[indexOf(subset, (unsigned)curr)];
+    }
+    if (__builtin_popcount(subset) == 1) {
+        return;
+    }
+
+    // only the split at that single node is needed
+    unsigned value = at(subset, (unsigned)curr), split = 0;
+    unsigned most_sig = (1u << 31u) >> (unsigned)__builtin_clz(subset);
+    for (unsigned d = (subset - 1) & subset; d & most_sig; d = (d - 1) & subset) {
+        if (at(d, (unsigned)curr) + at(subset - d, (unsigned)curr) == value) {
+            split = d;
+            break;
+        }
+    }
+    backtrackStored(split, curr, tree);
+    backtrackStored(subset - split, curr, tree);
+}
+
+void DreyfusWagner::appendPath(int root, std::vector<std::pair<int, int>> &tree) {
     int curr = root, prev = parent[curr];
     while (prev != -1) {
         tree.push_back({curr, prev});
         curr = prev;
         prev = parent[curr];
     }
-
-    backtrack(dp_par[subset][curr], curr, tree);
-    backtrack(subset - dp_par[subset][curr], curr, tree);
 }
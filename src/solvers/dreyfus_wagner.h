@@ -1,17 +1,32 @@
 #ifndef PACE2018_DREYFUS_WAGNER_H
 #define PACE2018_DREYFUS_WAGNER_H
 
+#include <algorithm>
 #include <climits>
-#include <cstring>
+#include <cmath>
+#include <cstdlib>
 #include <iostream>
-#include <queue>
+#include <memory>
 
 #include "solvers/solver.h"
+#include "utility/min_plus.h"
+#include "utility/shortest_paths.h"
 
 class DreyfusWagner : public Solver {
 public:
+    /**
+     * Order of the dp table in memory. Subset-major keeps the values of one subset over all nodes
+     * contiguous, which suits the vectorized merge. Root-major keeps the values of one node over
+     * all subsets contiguous instead.
+     */
+    enum class Layout {
+        SUBSET_MAJOR,
+        ROOT_MAJOR
+    };
+
     DreyfusWagner(const Graph &inputGraph, const TreeDecomposition &niceDecomposition)
-            : Solver(inputGraph, niceDecomposition) {
+            : Solver(inputGraph, niceDecomposition), layout(Layout::SUBSET_MAJOR),
+              queue(ShortestPaths::Queue::RADIX_HEAP), storePredecessors(false) {
         INFTY = (UINT_MAX >> 1u) - 10;
         if (INFTY < inputGraph.getEdgeWeightSum()) {
             // insufficient data type for the input graph weights
@@ -21,13 +36,65 @@ public:
 
     virtual Graph solve() override;
 
+    void setLayout(Layout tableLayout);
+    void setQueue(ShortestPaths::Queue pathsQueue);
+
+    /**
+     * Records the relaxation predecessor of every (subset, node) during the forward pass, so the
+     * solution is reconstructed by walking them instead of rerunning Dijkstra. Doubles the memory.
+     */
+    void setStorePredecessors(bool store);
+
+    /**
+     * Rough amount of work of a solve, the merges over all subset splits and the relaxations of
+     * every subset, in units comparable to the dp states of the decomposition based solvers
+     */
+    static double estimateWork(const Graph &graph);
+
 private:
+    // scratch space of a single thread for the relaxation phase
+    struct Workspace {
+        std::vector<unsigned> dist;
+        std::vector<int> parent;
+        ShortestPaths paths;
+    };
+
+    struct FreeDeleter {
+        void operator()(unsigned *ptr) const {
+            std::free(ptr);
+        }
+    };
+
+    void allocateTable(unsigned k, unsigned n);
+    void releaseTable();
+
+    size_t indexOf(unsigned subset, unsigned node) const {
+        return layout == Layout::SUBSET_MAJOR ? subset * stride + node : node * stride + subset;
+    }
+
+    unsigned &at(unsigned subset, unsigned node) {
+        return table[indexOf(subset, node)];
+    }
+
+    void solveSubset(unsigned subset, Workspace &workspace);
+    void mergeSubset(unsigned subset, unsigned *target) const;
+    void findSplits(unsigned subset, const unsigned *target, unsigned *splits) const;
     void backtrack(unsigned subset, int root, std::vector<std::pair<int, int>> &tree);
+    void backtrackStored(unsigned subset, int root, std::vector<std::pair<int, int>> &tree);
+
+    void appendPath(int root, std::vector<std::pair<int, int>> &tree);
 
-    unsigned ** dp, ** dp_par;
-    int * parent, * closed;
-    unsigned * dist;
+    Layout layout;
+    ShortestPaths::Queue queue;
+    bool storePredecessors;
+    std::unique_ptr<unsigned[], FreeDeleter> table;
+    size_t stride;
+    std::vector<int> predecessors;
+    std::vector<int> parent;
+    std::vector<unsigned> dist;
     unsigned INFTY;
+    std::vector<Workspace> workspaces;
+    ShortestPaths backtrackPaths;
 };
 
 
@@ -1,26 +1,29 @@
 #include "reduce_dp_solver.h"
 
-Graph ReduceDPSolver::solve() {
+template <typename Partition>
+Graph ReduceDPSolver<Partition>::solve() {
     initializeDP();
     markDeletableNodes();
 
-    for (unsigned i = decomposition.getNodeCount(); i > 0; i--) {
-        solveForNode(i - 1);
-        for (auto child : decomposition.getAdjacentTo(i-1)) {
+    solveBottomUp([this](unsigned nodeId) {
+        solveForNode(nodeId);
+        for (auto child : decomposition.getAdjacentTo(nodeId)) {
             if (deletable[child]) {
                 eraseNodeBacktrack((unsigned)child);
             }
         }
-    }
+    });
 
     // TODO: non-temporary output
     FullBacktrackEntry startPoint = findResult();
-    unsigned result = dpCache[startPoint.nodeId][startPoint.subset][startPoint.partition];
+    unsigned result = dpCache[startPoint.nodeId][startPoint.subset].costOf(startPoint.partition);
 
     std::cout << "VALUE " << result + graph.getPreselectedWeight() << std::endl;
     backtrack(startPoint.nodeId, startPoint.subset, startPoint.partition);
     for (auto edge : resultEdges) {
-        std::cout << edge.first + 1 << " " << edge.second + 1 << std::endl;
+        for (auto original : graph.expandEdge(edge)) {
+            std::cout << original.first + 1 << " " << original.second + 1 << std::endl;
+        }
     }
     for (auto edge : graph.getPreselectedEdges()) {
         std::cout << edge.first + 1 << " " << edge.second + 1 << std::endl;
@@ -32,33 +35,30 @@ Graph ReduceDPSolver::solve() {
     std::cout << "  FORGET time        " << (double)forgetTime / CLOCKS_PER_SEC  << "s" << std::endl;
     std::cout << "  JOIN time          " << (double)joinTime / CLOCKS_PER_SEC    << "s" << std::endl;
     std::cout << "  EDGE time          " << (double)edgeTime / CLOCKS_PER_SEC    << "s" << std::endl;
-    std::cout << "CUT MATRIX GEN time  " << (double)matrixTime / CLOCKS_PER_SEC  << "s" << std::endl;
-    std::cout << "CUT MATRIX ELIM time " << (double)elimTime / CLOCKS_PER_SEC  << "s" << std::endl;
+    std::cout << "CUT MATRIX time      " << (double)matrixTime / CLOCKS_PER_SEC  << "s" << std::endl;
     std::cout << "REDUCE OVERHEAD time " << (double)overheadTime / CLOCKS_PER_SEC  << "s" << std::endl;
      */
 
     return Graph();
 }
 
-void ReduceDPSolver::initializeDP() {
+template <typename Partition>
+void ReduceDPSolver<Partition>::initializeDP() {
     unsigned treeNodes = decomposition.getNodeCount();
     dpCache.resize(treeNodes);
-    dpBacktrack.resize(treeNodes);
     for (unsigned i = 0; i < treeNodes; ++i) {
-        auto bagSize = decomposition.getBagOf(i).size();
-        // 64b variable insufficient for partitions
-        if (bagSize > 16) {
+        // the partition encoding is insufficient
+        if (decomposition.getBagOf(i).size() > MAX_BAG_SIZE) {
             std::cerr << "Error: bags too large!" << std::endl;
             exit(1);
         }
-
-        dpCache[i].resize(1u << bagSize);
-        dpBacktrack[i].resize(1u << bagSize);
     }
+    solutionDAG.clear();
     resultEdges.clear();
 }
 
-void ReduceDPSolver::markDeletableNodes() {
+template <typename Partition>
+void ReduceDPSolver<Partition>::markDeletableNodes() {
     int nodeId = 1;
     deletable.resize(decomposition.getNodeCount(), true);
     bool stopAtNext = false;
@@ -100,47 +100,31 @@ void ReduceDPSolver::markDeletableNodes() {
     }
 }
 
-ReduceDPSolver::FullBacktrackEntry ReduceDPSolver::findResult() {
+template <typename Partition>
+typename ReduceDPSolver<Partition>::FullBacktrackEntry ReduceDPSolver<Partition>::findResult() {
     unsigned bestResult = UINT_MAX;
-    FullBacktrackEntry bestEntry = {0, 0, 0};
+    FullBacktrackEntry bestEntry = {0, 0, Partition{}};
     for (unsigned nodeId = 1; nodeId < decomposition.getNodeCount(); nodeId++) {
         if (deletable[nodeId]) {
             continue;
         }
 
         TreeDecomposition::Node node = decomposition.getNodeAt(nodeId);
-        unsigned termMask = 0, termCount = 0, varCount = 0;
-        for (unsigned i = 0; i < node.bag.size(); i++) {
-            if (graph.isTerm(node.bag[i])) {
-                termMask |= 1u << i;
-                termCount++;
-            } else {
-                varCount++;
-            }
-        }
+        unsigned termMask = node.index.termMask, termCount = (unsigned)__builtin_popcount(termMask),
+                varCount = (unsigned)node.bag.size() - termCount;
 
         for (unsigned varSubset = 0; varSubset < (1u << varCount); varSubset++) {
             // scatter variables to the full subset
-            uint16_t subset = 0;
-            unsigned varIdx = 0;
-            for (unsigned i = 0; i < varCount + termCount; i++) {
-                if ((termMask & (1u << i)) != 0) {
-                    subset |= (1u << i);
-                } else {
-                    if ((varSubset & (1u << varIdx)) != 0) {
-                        subset |= (1u << i);
-                    }
-                    varIdx++;
-                }
-            }
+            unsigned subset = termMask | depositBits(varSubset, ~termMask & lowBits(varCount + termCount));
 
             unsigned candidate = UINT_MAX;
-            if (dpCache[nodeId][subset].count(0) != 0) {
-                candidate = dpCache[nodeId][subset][0];
+            const StateEntry *entry = dpCache[nodeId][subset].find(Partition{});
+            if (entry != nullptr) {
+                candidate = entry->cost;
             }
             if (candidate < bestResult) {
                 bestResult = candidate;
-                bestEntry = {nodeId, subset, 0};
+                bestEntry = {(int)nodeId, subset, Partition{}};
             }
         }
     }
@@ -148,108 +132,76 @@ ReduceDPSolver::FullBacktrackEntry ReduceDPSolver::findResult() {
     return bestEntry;
 }
 
-bool ReduceDPSolver::branchContainsTerminal(int nodeId) {
-    TreeDecomposition::Node node = decomposition.getNodeAt(nodeId);
+template <typename Partition>
+bool ReduceDPSolver<Partition>::branchContainsTerminal(int nodeId) {
+    // explicit stack, branches of path-like decompositions are too deep to recurse into
+    std::vector<int> stack = {nodeId};
+    while (!stack.empty()) {
+        const TreeDecomposition::NodeIndex &index = decomposition.getIndexOf(stack.back());
+        stack.pop_back();
 
-    for (auto item : node.bag) {
-        if (graph.isTerm(item)) {
+        if (index.termMask != 0) {
             return true;
         }
+        for (auto child : index.children) {
+            if (child != -1) {
+                stack.push_back(child);
+            }
+        }
     }
-
-    if (node.type == TreeDecomposition::LEAF) {
-        return false;
-    }
-
-    if (node.type == TreeDecomposition::JOIN) {
-        return branchContainsTerminal(node.adjacent[0]) || branchContainsTerminal(node.adjacent[1]);
-    }
-    return branchContainsTerminal(node.adjacent[0]);
+    return false;
 }
 
+template <typename Partition>
+void ReduceDPSolver<Partition>::backtrack(int treeNode, unsigned subset, const Partition &partition) {
+    int handle = dpCache[treeNode][subset].handleOf(partition);
 
-void ReduceDPSolver::backtrack(int treeNode, unsigned subset, uint64_t partition) {
-    EdgeBacktrack edges = dpBacktrack[treeNode][subset][partition];
-
-    for (int edgeId = 0; edgeId < graph.getEdgeCount(); edgeId++) {
-        if (edges.get((unsigned)edgeId)) {
-            resultEdges.push_back(graph.edgeWithId(edgeId));
-        }
+    for (int edgeId : solutionDAG.collectEdges(handle)) {
+        resultEdges.push_back(graph.edgeWithId(edgeId));
     }
 }
 
-void ReduceDPSolver::solveForNode(unsigned nodeId) {
+template <typename Partition>
+void ReduceDPSolver<Partition>::solveForNode(unsigned nodeId) {
     TreeDecomposition::Node node = decomposition.getNodeAt(nodeId);
 
     // find all subsets, terminals always stay on
-    unsigned termMask = 0, termCount = 0, varCount = 0;
-    for (unsigned i = 0; i < node.bag.size(); i++) {
-        if (graph.isTerm(node.bag[i])) {
-            termMask |= 1u << i;
-            termCount++;
-        } else {
-            varCount++;
-        }
-    }
+    unsigned termMask = node.index.termMask, termCount = (unsigned)__builtin_popcount(termMask),
+            varCount = (unsigned)node.bag.size() - termCount;
+    // tables are allocated as the node is reached, wide bags have plenty of them
+    dpCache[nodeId].resize(1u << node.bag.size());
 
-    // iterate over subsets of variable nodes
-    for (unsigned varSubset = 0; varSubset < (1u << varCount); varSubset++) {
+    // iterate over subsets of variable nodes, each of them only writes its own table
+    getPool().parallelFor(0, 1u << varCount, [&](unsigned varSubset) {
         // scatter variables to the full subset
-        unsigned subset = 0, varIdx = 0;
-        for (unsigned i = 0; i < varCount + termCount; i++) {
-            if ((termMask & (1u << i)) != 0) {
-                subset |= (1u << i);
-            } else {
-                if ((varSubset & (1u << varIdx)) != 0) {
-                    subset |= (1u << i);
-                }
-                varIdx++;
-            }
-        }
+        unsigned subset = termMask | depositBits(varSubset, ~termMask & lowBits(varCount + termCount));
 
         solveForSubset(nodeId, subset);
-    }
+    });
 }
 
-void ReduceDPSolver::eraseNodeBacktrack(unsigned nodeId) {
+template <typename Partition>
+void ReduceDPSolver<Partition>::eraseNodeBacktrack(unsigned nodeId) {
     TreeDecomposition::Node node = decomposition.getNodeAt(nodeId);
 
     // find all subsets, terminals always stay on
-    unsigned termMask = 0, termCount = 0, varCount = 0;
-    for (unsigned i = 0; i < node.bag.size(); i++) {
-        if (graph.isTerm(node.bag[i])) {
-            termMask |= 1u << i;
-            termCount++;
-        } else {
-            varCount++;
-        }
-    }
+    unsigned termMask = node.index.termMask, termCount = (unsigned)__builtin_popcount(termMask),
+            varCount = (unsigned)node.bag.size() - termCount;
 
     // iterate over subsets of variable nodes
     for (unsigned varSubset = 0; varSubset < (1u << varCount); varSubset++) {
         // scatter variables to the full subset
-        unsigned subset = 0, varIdx = 0;
-        for (unsigned i = 0; i < varCount + termCount; i++) {
-            if ((termMask & (1u << i)) != 0) {
-                subset |= (1u << i);
-            } else {
-                if ((varSubset & (1u << varIdx)) != 0) {
-                    subset |= (1u << i);
-                }
-                varIdx++;
-            }
-        }
+        unsigned subset = termMask | depositBits(varSubset, ~termMask & lowBits(varCount + termCount));
 
         dpCache[nodeId][subset].clear();
-        dpBacktrack[nodeId][subset].clear();
     }
+    std::vector<Table>().swap(dpCache[nodeId]);
 }
 
-void ReduceDPSolver::solveForSubset(unsigned nodeId, unsigned subset) {
-    TreeDecomposition::Node node = decomposition.getNodeAt(nodeId);
-
+template <typename Partition>
+void ReduceDPSolver<Partition>::solveForSubset(unsigned nodeId, unsigned subset) {
     clock_t startTime = clock();
-    std::vector<uint64_t> partitions = generateParts(nodeId, subset);
+    generateParts(nodeId, subset);
     partTime += clock() - startTime;
 
     // reduce the number of partitions
@@ -258,318 +210,228 @@ void ReduceDPSolver::solveForSubset(unsigned nodeId, unsigned subset) {
     }
 }
 
-void ReduceDPSolver::reduce(unsigned nodeId, unsigned subset) {
+template <typename Partition>
+void ReduceDPSolver<Partition>::reduce(unsigned nodeId, unsigned subset) {
     clock_t startTime = clock();
     TreeDecomposition::Node node = decomposition.getNodeAt(nodeId);
 
-    std::vector<uint64_t> partitions;
-
-    for (auto entry : dpCache[nodeId][subset]) {
-        partitions.push_back(entry.first);
+    Table &states = dpCache[nodeId][subset];
+    if ((states.size() << 1u) <= (1u << (unsigned)(__builtin_popcount(subset)))) {
+        return;
     }
-    overheadTime += clock() - startTime;
-
-    if ((partitions.size() << 1u) > (1u << (unsigned)(__builtin_popcount(subset)))) {
-        std::sort(partitions.begin(), partitions.end(), [&](const uint64_t& a, const uint64_t& b) {
-            return dpCache[nodeId][subset][a] < dpCache[nodeId][subset][b];
-        });
 
-        startTime = clock();
-        CutMatrix cutMatrix;
-        cutMatrix.generate(partitions, subset, (unsigned) node.bag.size());
-        matrixTime += clock() - startTime;
-
-        startTime = clock();
-        cutMatrix.eliminate();
-        partitions = cutMatrix.getPartitions();
-        elimTime += clock() - startTime;
+    std::vector<const StateEntry*> sortedStates;
+    for (auto &entry : states) {
+        sortedStates.push_back(&entry);
     }
+    std::sort(sortedStates.begin(), sortedStates.end(),
+              [](const StateEntry *a, const StateEntry *b) {
+        return a->cost < b->cost;
+    });
+    overheadTime += clock() - startTime;
 
+    // cheapest states first, until the kept ones span all cuts
     startTime = clock();
-    std::unordered_map<uint64_t, unsigned> newPart;
-    for (auto part : partitions) {
-        newPart[part] = dpCache[nodeId][subset][part];
+    CutMatrix<Partition> cutMatrix(subset, (unsigned)node.bag.size());
+    Table reduced;
+    for (auto entry : sortedStates) {
+        if (cutMatrix.insert(entry->partition)) {
+            reduced.improve(entry->partition, entry->cost)->handle = entry->handle;
+            if (cutMatrix.isFull()) {
+                break;
+            }
+        }
     }
-    dpCache[nodeId][subset] = newPart;
-    overheadTime += clock() - startTime;
+    states = std::move(reduced);
+    matrixTime += clock() - startTime;
 }
 
-std::vector<uint64_t> ReduceDPSolver::generateIntroParts(int nodeId, unsigned subset, uint64_t sourcePart,
-                                                         unsigned childSubset) {
+template <typename Partition>
+void ReduceDPSolver<Partition>::generateIntroParts(int nodeId, unsigned subset, const StateEntry& source) {
     TreeDecomposition::Node node = decomposition.getNodeAt(nodeId);
-    int child = node.adjacent[0];
 
     // get the id of the introduced node
-    int introduced = node.associatedNode;
-    unsigned candidate = dpCache[child][childSubset][sourcePart];
-    unsigned introducedId = 0;
-    while (node.bag[introducedId] != introduced) {
-        introducedId++;
-    }
-
-    // find new partition ID
-    char newPartitionId = 0;
-    std::vector<char> vPartition = partitionToVec((unsigned)node.bag.size() - 1, sourcePart);
-    if (isInSubset(introducedId, subset)) {
-        char maxPartitionId = 0;
-        for (unsigned i = 0; i < vPartition.size(); i++) {
-            if (vPartition[i] > maxPartitionId && isInSubset(i, childSubset)) {
-                maxPartitionId = vPartition[i];
-            }
-        }
-        newPartitionId = maxPartitionId + (char)1;
-    }
+    unsigned introducedId = node.index.position;
 
-    // assign the new partition to the introduced node
-    vPartition.insert(vPartition.begin() + introducedId, newPartitionId);
-    uint64_t parentPart = vecToPartition(vPartition, subset);
-    if (dpCache[nodeId][subset].count(parentPart) == 0
-        || candidate < dpCache[nodeId][subset][parentPart]) {
-        dpCache[nodeId][subset][parentPart] = candidate;
-        dpBacktrack[nodeId][subset][parentPart] = dpBacktrack[child][childSubset][sourcePart];
+    // the introduced node gets a component of its own, child components are below the child bag size
+    auto childSize = (unsigned)node.bag.size() - 1;
+    Partition parentPart = canonizePartition(insertComponentAt(source.partition, introducedId, childSize, childSize),
+                                             subset, childSize + 1);
+    StateEntry *entry = dpCache[nodeId][subset].improve(parentPart, source.cost);
+    if (entry != nullptr) {
+        entry->handle = source.handle;
     }
-    return {parentPart};
 }
 
-std::vector<uint64_t> ReduceDPSolver::generateForgetParts(int nodeId, unsigned subset, uint64_t sourcePart,
-                                                          unsigned childSubset) {
+template <typename Partition>
+void ReduceDPSolver<Partition>::generateForgetParts(int nodeId, unsigned subset, const StateEntry& source,
+                                                    unsigned childSubset) {
     TreeDecomposition::Node node = decomposition.getNodeAt(nodeId);
 
-    // get the singular child
-    int child = node.adjacent[0];
-    const TreeDecomposition::Node &childNode = decomposition.getNodeAt(child);
-
-    // get id of the forgotten node in child
-    int forgotten = node.associatedNode;
-    unsigned forgottenId = 0;
-    unsigned candidate = dpCache[child][childSubset][sourcePart];
-    while (childNode.bag[forgottenId] != forgotten) {
-        forgottenId++;
-    }
+    // get the singular child and the id of the forgotten node in it
+    const TreeDecomposition::Node childNode = decomposition.getNodeAt(node.index.children[0]);
+    unsigned forgottenId = node.index.position;
 
     // if the forgotten node is used and in a separate partition, we don't have the optimal solution
     if (isInSubset(forgottenId, childSubset)) {
         bool foundAdj = false;
-        int forgottenComponent = getComponentAt(sourcePart, forgottenId);
+        int forgottenComponent = getComponentAt(source.partition, forgottenId);
         for (unsigned i = 0; i < childNode.bag.size(); i++) {
             if (isInSubset(i, childSubset) &&
                     i != forgottenId &&
-                    getComponentAt(sourcePart, i) == forgottenComponent) {
+                    getComponentAt(source.partition, i) == forgottenComponent) {
                 foundAdj = true;
                 break;
             }
         }
         if (!foundAdj) {
-            return {};
+            return;
         }
     }
 
-    std::vector<char> vChildPartition = partitionToVec((unsigned)childNode.bag.size(), sourcePart);
-    uint64_t parentPartition = partitionWithoutElement(vChildPartition, forgottenId, subset);
+    Partition parentPartition = canonizePartition(eraseComponentAt(source.partition, forgottenId,
+                                                                   (unsigned)childNode.bag.size()),
+                                                  subset, (unsigned)node.bag.size());
 
     // forward the results
-    if (dpCache[nodeId][subset].count(parentPartition) == 0
-        || candidate < dpCache[nodeId][subset][parentPartition]) {
-        dpCache[nodeId][subset][parentPartition] = candidate;
-        dpBacktrack[nodeId][subset][parentPartition] = dpBacktrack[child][childSubset][sourcePart];
+    StateEntry *entry = dpCache[nodeId][subset].improve(parentPartition, source.cost);
+    if (entry != nullptr) {
+        entry->handle = source.handle;
     }
-
-    return {parentPartition};
 }
 
-std::vector<uint64_t> ReduceDPSolver::generateJoinParts(int nodeId, unsigned subset,
-                                                        const std::vector<uint64_t>& sourceParts1,
-                                                        const std::vector<uint64_t>& sourceParts2) {
+template <typename Partition>
+void ReduceDPSolver<Partition>::generateJoinParts(int nodeId, unsigned subset,
+                                                  const Table& sourceParts1,
+                                                  const Table& sourceParts2) {
     TreeDecomposition::Node node = decomposition.getNodeAt(nodeId);
-    int children[2] = {node.adjacent[0], node.adjacent[1]};
 
-    std::unordered_set<uint64_t> partitions;
     UnionFindMerger merger((unsigned)node.bag.size(), subset);
-    for (auto p1 : sourceParts1) {
-        for (auto p2 : sourceParts2) {
-            uint64_t merged = merger.merge(p1, p2);
-            if (merged == PARTITION_INVALID) {
+    for (auto &p1 : sourceParts1) {
+        for (auto &p2 : sourceParts2) {
+            Partition merged = merger.join(p1.partition, p2.partition);
+            if (merged == PartitionTraits<Partition>::empty()) {
                 continue;
             }
 
             // precompute results
-            unsigned candidate = dpCache[children[0]][subset][p1]
-                                 + dpCache[children[1]][subset][p2];
-
-
-            if (dpCache[nodeId][subset].count(merged) == 0
-                || candidate < dpCache[nodeId][subset][merged]) {
-                dpCache[nodeId][subset][merged] = candidate;
+            unsigned candidate = p1.cost + p2.cost;
 
+            StateEntry *entry = dpCache[nodeId][subset].improve(merged, candidate);
+            if (entry != nullptr) {
                 // save backtrack information
-                EdgeBacktrack edges1 = dpBacktrack[children[0]][subset][p1],
-                        edges2 = dpBacktrack[children[1]][subset][p2];
-                edges1.mergeWith(edges2);
-                dpBacktrack[nodeId][subset][merged] = edges1;
+                entry->handle = solutionDAG.join(p1.handle, p2.handle);
             }
-
-            partitions.insert(merged);
         }
     }
-
-    std::vector<uint64_t> vPartitions(partitions.begin(), partitions.end());
-    return vPartitions;
 }
 
-std::vector<uint64_t> ReduceDPSolver::generateEdgeParts(int nodeId, unsigned subset, uint64_t sourcePart) {
+template <typename Partition>
+void ReduceDPSolver<Partition>::generateEdgeParts(int nodeId, unsigned subset, const StateEntry& source) {
     TreeDecomposition::Node node = decomposition.getNodeAt(nodeId);
-    // get the singular child
-    int child = node.adjacent[0];
-    std::vector<uint64_t> partitions;
 
     // case where we don't use the edge, forward the result to the cache
-    partitions.push_back(sourcePart);
-    unsigned candidate = dpCache[child][subset][sourcePart];
-    if (dpCache[nodeId][subset].count(sourcePart) == 0
-        || dpCache[nodeId][subset][sourcePart] > candidate) {
-        dpCache[nodeId][subset][sourcePart] = candidate;
-        dpBacktrack[nodeId][subset][sourcePart] = dpBacktrack[child][subset][sourcePart];
+    StateEntry *entry = dpCache[nodeId][subset].improve(source.partition, source.cost);
+    if (entry != nullptr) {
+        entry->handle = source.handle;
     }
 
-    // get both endpoints of the new edge
-    int intro1 = node.associatedEdge.first,
-        intro2 = node.associatedEdge.second;
-
     // get both edge endpoint ids
-    unsigned end1id = 0, end2id = 0;
-    while (node.bag[end1id] != intro1) {
-        end1id++;
-    }
-    while (node.bag[end2id] != intro2) {
-        end2id++;
-    }
+    unsigned end1id = node.index.edgePositions[0], end2id = node.index.edgePositions[1];
 
     if (!isInSubset(end1id, subset) || !isInSubset(end2id, subset)) {
-        return partitions;
+        return;
     }
 
     // if edge is used, merge the parts above
-    if (getComponentAt(sourcePart, end1id) != getComponentAt(sourcePart, end2id)) {
-        std::vector<char> vPartition = partitionToVec((unsigned)node.bag.size(), sourcePart);
-        char partToReplace = vPartition[end2id], replaceBy = vPartition[end1id];
-        for (auto& comp : vPartition) {
-            if (comp == partToReplace) {
-                comp = replaceBy;
-            }
-        }
-        uint64_t newPart = vecToPartition(vPartition, subset);
-        partitions.push_back(newPart);
+    if (getComponentAt(source.partition, end1id) != getComponentAt(source.partition, end2id)) {
+        auto size = (unsigned)node.bag.size();
+        Partition newPart = canonizePartition(relabelComponent(source.partition,
+                                                               (unsigned)getComponentAt(source.partition, end2id),
+                                                               (unsigned)getComponentAt(source.partition, end1id),
+                                                               subset, size),
+                                              subset, size);
 
         // add weight of the edge to the candidate solution (edge is used)
-        candidate += graph.getAdjacentOf(intro1).at(intro2);
+        unsigned candidate = source.cost + node.index.edgeWeight;
 
         // forward the result to the table
-        if (dpCache[nodeId][subset].count(newPart) == 0
-            || dpCache[nodeId][subset][newPart] > candidate) {
-            dpCache[nodeId][subset][newPart] = candidate;
+        entry = dpCache[nodeId][subset].improve(newPart, candidate);
+        if (entry != nullptr) {
             // add edge to the backtrack table
-            EdgeBacktrack btEdge = dpBacktrack[child][subset][sourcePart];
-            btEdge.turnOn((unsigned)graph.idOfEdge(std::minmax(intro1, intro2)));
-            dpBacktrack[nodeId][subset][newPart] = btEdge;
+            entry->handle = solutionDAG.addEdge(source.handle, node.index.edgeId);
         }
     }
-
-    return partitions;
 }
 
-std::vector<uint64_t> ReduceDPSolver::generateParts(int nodeId, unsigned subset) {
+template <typename Partition>
+void ReduceDPSolver<Partition>::generateParts(int nodeId, unsigned subset) {
     TreeDecomposition::Node node = decomposition.getNodeAt(nodeId);
     clock_t stime = clock();
-    int children[2] = {-1, -1}, childPtr = 0;
-    for (auto adj : node.adjacent) {
-        if (adj < nodeId) {
-            continue;
-        }
-        children[childPtr++] = adj;
-    }
+    const int *children = node.index.children;
 
     if (node.type == TreeDecomposition::JOIN) {
-        std::vector<uint64_t> source1, source2;
-        for (auto i : dpCache[children[0]][subset]) {
-            source1.push_back(i.first);
-        }
-        for (auto i : dpCache[children[1]][subset]) {
-            source2.push_back(i.first);
-        }
-        std::vector<uint64_t > r = generateJoinParts(nodeId, subset, source1, source2);
+        generateJoinParts(nodeId, subset, dpCache[children[0]][subset], dpCache[children[1]][subset]);
         joinTime += clock() - stime;
-        return r;
+        return;
     }
 
 
     if (node.type == TreeDecomposition::LEAF) {
-        dpCache[nodeId][subset][0] = 0;
-        dpBacktrack[nodeId][subset][0] = EdgeBacktrack((unsigned)graph.getEdgeCount());
-        return {0};
+        dpCache[nodeId][subset].improve(Partition{}, 0)->handle = SolutionDAG::EMPTY;
+        return;
     }
 
-    std::unordered_set<uint64_t> setResult;
-
     if (node.type == TreeDecomposition::INTRO) {
-        int introduced = node.associatedNode;
-        unsigned introducedId = 0;
-        while (node.bag[introducedId] != introduced) {
-            introducedId++;
-        }
+        unsigned introducedId = node.index.position;
         unsigned childSubset = maskWithoutElement(subset, introducedId, (unsigned)node.bag.size());
-        for (auto i : dpCache[children[0]][childSubset]) {
-            std::vector<uint64_t> generatedByPart = generateIntroParts(nodeId, subset, i.first, childSubset);
-            for (auto part : generatedByPart) {
-                setResult.insert(part);
-            }
+        for (auto &i : dpCache[children[0]][childSubset]) {
+            generateIntroParts(nodeId, subset, i);
         }
         introTime += clock() - stime;
     }
 
     if (node.type == TreeDecomposition::FORGET) {
-        const TreeDecomposition::Node &childNode = decomposition.getNodeAt(children[0]);
-
         // get id of the forgotten node in child
         int forgotten = node.associatedNode;
-        unsigned childSubset1, childSubset2, forgottenId = 0;
-        while (childNode.bag[forgottenId] != forgotten) {
-            forgottenId++;
-        }
+        unsigned childSubset1, childSubset2, forgottenId = node.index.position;
         childSubset1 = maskWithElement(subset, forgottenId, 0, (unsigned)node.bag.size());
         childSubset2 = maskWithElement(subset, forgottenId, 1, (unsigned)node.bag.size());
 
         // forgotten node wasn't used
         if (!graph.isTerm(forgotten)) {
-            for (auto i : dpCache[children[0]][childSubset1]) {
-                std::vector<uint64_t> generatedByPart = generateForgetParts(nodeId, subset, i.first, childSubset1);
-                for (auto part : generatedByPart) {
-                    setResult.insert(part);
-                }
+            for (auto &i : dpCache[children[0]][childSubset1]) {
+                generateForgetParts(nodeId, subset, i, childSubset1);
             }
         }
 
         // forgotten node was used
-        for (auto i : dpCache[children[0]][childSubset2]) {
-            std::vector<uint64_t> generatedByPart = generateForgetParts(nodeId, subset, i.first, childSubset2);
-            for (auto part : generatedByPart) {
-                setResult.insert(part);
-            }
+        for (auto &i : dpCache[children[0]][childSubset2]) {
+            generateForgetParts(nodeId, subset, i, childSubset2);
         }
 
         forgetTime += clock() - stime;
     }
 
     if (node.type == TreeDecomposition::INTRO_EDGE) {
-        for (auto i : dpCache[children[0]][subset]) {
-            std::vector<uint64_t> generatedByPart = generateEdgeParts(nodeId, subset, i.first);
-            for (auto part : generatedByPart) {
-                setResult.insert(part);
-            }
+        for (auto &i : dpCache[children[0]][subset]) {
+            generateEdgeParts(nodeId, subset, i);
         }
 
         edgeTime += clock() - stime;
     }
+}
 
-    std::vector<uint64_t> result(setResult.begin(), setResult.end());
-    return result;
-}
\ No newline at end of file
+template class ReduceDPSolver<uint64_t>;
+template class ReduceDPSolver<uint128_t>;
+template class ReduceDPSolver<std::array<uint64_t, 4>>;
+
+std::unique_ptr<Solver> makeReduceDPSolver(const Graph &inputGraph, const TreeDecomposition &niceDecomposition) {
+    if (niceDecomposition.getWidth() <= ReduceDPSolver<uint64_t>::MAX_BAG_SIZE) {
+        return std::make_unique<ReduceDPSolver<uint64_t>>(inputGraph, niceDecomposition);
+    }
+    if (niceDecomposition.getWidth() <= ReduceDPSolver<uint128_t>::MAX_BAG_SIZE) {
+        return std::make_unique<ReduceDPSolver<uint128_t>>(inputGraph, niceDecomposition);
+    }
+    return std::make_unique<ReduceDPSolver<std::array<uint64_t, 4>>>(inputGraph, niceDecomposition);
+}
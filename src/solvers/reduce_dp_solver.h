@@ -1,22 +1,28 @@
 #ifndef PACE2018_REDUCE_DP_SOLVER_H
 #define PACE2018_REDUCE_DP_SOLVER_H
 
+#include <atomic>
 #include <climits>
 #include <ctime>
-#include <unordered_map>
-#include <unordered_set>
+#include <memory>
 #include <vector>
 
 #include "solvers/solver.h"
 #include "structures/cut_matrix.h"
+#include "structures/solution_dag.h"
+#include "structures/state_table.h"
 #include "utility/partitioner.h"
 #include "utility/partition_mergers.h"
 
+/**
+ * Rank based DP over the nice decomposition, partitions of the bag use the given packed encoding
+ */
+template <typename Partition = uint64_t>
 class ReduceDPSolver : public Solver {
 public:
     ReduceDPSolver(const Graph &inputGraph, const TreeDecomposition &niceDecomposition)
             : Solver(inputGraph, niceDecomposition),
-              matrixTime(0), elimTime(0), partTime(0), overheadTime(0),
+              matrixTime(0), partTime(0), overheadTime(0),
               introTime(0), forgetTime(0), joinTime(0), edgeTime(0) {
         if ((long long)UINT_MAX < inputGraph.getEdgeWeightSum()) {
             // insufficient data type for the input graph weights
@@ -28,9 +34,17 @@ public:
 
     Graph solve() override;
 
+    /**
+     * Time of a single dp state relative to a unit of DreyfusWagner::estimateWork, measured on grid instances
+     */
+    static constexpr double STATE_COST = 500;
+
+    // subsets of the bag are unsigned masks
+    static const unsigned MAX_BAG_SIZE = std::min(PartitionTraits<Partition>::MAX_SIZE, 31u);
+
 private:
     void initializeDP();
-    void backtrack(int treeNode, unsigned subset, uint64_t partition);
+    void backtrack(int treeNode, unsigned subset, const Partition &partition);
 
     void solveForNode(unsigned nodeId);
     void eraseNodeBacktrack(unsigned nodeId);
@@ -39,49 +53,25 @@ private:
 
     void reduce(unsigned nodeId, unsigned subset);
 
-    std::vector<uint64_t> generateParts(int nodeId, unsigned subset);
-
-    std::vector<uint64_t> generateIntroParts(int nodeId, unsigned subset, uint64_t sourcePart,
-                                             unsigned childSubset);
-    std::vector<uint64_t> generateForgetParts(int nodeId, unsigned subset, uint64_t sourcePart,
-                                              unsigned childSubset);
-    std::vector<uint64_t> generateJoinParts(int nodeId, unsigned subset,
-                                            const std::vector<uint64_t>& sourceParts1,
-                                            const std::vector<uint64_t>& sourceParts2);
-    std::vector<uint64_t> generateEdgeParts(int nodeId, unsigned subset, uint64_t sourcePart);
-
-    std::vector<std::vector<std::unordered_map<uint64_t, unsigned>>> dpCache;
-
     struct FullBacktrackEntry {
         int nodeId;
-        uint16_t subset;
-        uint64_t partition;
+        unsigned subset;
+        Partition partition;
     };
 
-    struct EdgeBacktrack {
-        std::vector<uint64_t> bset;
+    typedef StateTable<int, Partition> Table;
+    typedef typename Table::Entry StateEntry;
 
-        EdgeBacktrack() {}
+    void generateParts(int nodeId, unsigned subset);
 
-        EdgeBacktrack(unsigned size) {
-            bset.resize(((size + 63u) >> 6u), 0);
-        }
+    void generateIntroParts(int nodeId, unsigned subset, const StateEntry& source);
+    void generateForgetParts(int nodeId, unsigned subset, const StateEntry& source, unsigned childSubset);
+    void generateJoinParts(int nodeId, unsigned subset, const Table& sourceParts1, const Table& sourceParts2);
+    void generateEdgeParts(int nodeId, unsigned subset, const StateEntry& source);
 
-        bool get(unsigned idx) const {
-            return (bset[idx >> 6u] & (1ull << (idx % 64))) != 0;
-        }
-
-        void turnOn(unsigned idx) {
-            bset[idx >> 6u] |= 1ull << (idx % 64);
-        }
-
-        void mergeWith(const EdgeBacktrack& toMerge) {
-            for (unsigned i = 0; i < bset.size(); i++) {
-                bset[i] |= toMerge.bset[i];
-            }
-        }
-
-    };
+    // DP states of every node and subset, keyed by partition, with their solution records
+    std::vector<std::vector<Table>> dpCache;
+    SolutionDAG solutionDAG;
 
     FullBacktrackEntry findResult();
 
@@ -90,13 +80,18 @@ private:
 
     bool branchContainsTerminal(int nodeId);
 
-    std::vector<std::vector<std::unordered_map<uint64_t, EdgeBacktrack>>>
-            dpBacktrack;
     std::vector<std::pair<int, int>> resultEdges;
 
-    clock_t matrixTime, elimTime, partTime, overheadTime;
-    clock_t introTime, forgetTime, joinTime, edgeTime;
+    // shared by all threads of the bottom-up traversal
+    std::atomic<clock_t> matrixTime, partTime, overheadTime;
+    std::atomic<clock_t> introTime, forgetTime, joinTime, edgeTime;
 };
 
 
+/**
+ * Reduce solver instantiated with the narrowest partition encoding fitting the bags of the decomposition
+ */
+std::unique_ptr<Solver> makeReduceDPSolver(const Graph &inputGraph, const TreeDecomposition &niceDecomposition);
+
+
 #endif //PACE2018_REDUCE_DP_SOLVER_H
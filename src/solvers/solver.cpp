@@ -0,0 +1,59 @@
+#include "solver.h"
+
+void Solver::setThreadCount(unsigned count) {
+    threadCount = std::max(1u, count);
+    pool.reset();
+}
+
+ThreadPool &Solver::getPool() {
+    if (!pool) {
+        pool = std::make_unique<ThreadPool>(threadCount);
+    }
+    return *pool;
+}
+
+void Solver::solveBottomUp(const std::function<void(unsigned)> &solveNode) {
+    unsigned nodeCount = decomposition.getNodeCount();
+    if (nodeCount == 0) {
+        return;
+    }
+
+    // count unfinished children of every node
+    std::vector<int> parent(nodeCount, -1);
+    std::unique_ptr<std::atomic<unsigned>[]> pending(new std::atomic<unsigned>[nodeCount]);
+    for (unsigned i = 0; i < nodeCount; i++) {
+        pending[i] = (unsigned)decomposition.getAdjacentTo(i).size();
+        for (auto child : decomposition.getAdjacentTo(i)) {
+            parent[child] = i;
+        }
+    }
+
+    ThreadPool &workers = getPool();
+    std::atomic<unsigned> finished(0);
+    std::function<void(unsigned)> process = [&](unsigned nodeId) {
+        solveNode(nodeId);
+
+        // the last finished child releases its parent
+        int parentId = parent[nodeId];
+        if (parentId != -1 && --pending[parentId] == 0) {
+            workers.submit([&process, parentId]() {
+                process((unsigned)parentId);
+            });
+        }
+
+        // nothing on this stack frame may be touched once the root is counted
+        finished++;
+    };
+
+    // start in the leaves, deepest ones end up on top of the queue
+    for (unsigned i = 0; i < nodeCount; i++) {
+        if (pending[i] == 0) {
+            workers.submit([&process, i]() {
+                process(i);
+            });
+        }
+    }
+    workers.waitUntil([&]() {
+        return finished == nodeCount;
+    });
+}
@@ -1,19 +1,41 @@
 #ifndef PACE2018_SOLVER_H
 #define PACE2018_SOLVER_H
 
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <thread>
+
 #include "structures/graph.h"
 #include "structures/tree_decomposition.h"
+#include "utility/thread_pool.h"
 
 class Solver {
 public:
     Solver(const Graph& inputGraph, const TreeDecomposition &niceDecomposition) :
         graph(inputGraph),
-        decomposition(niceDecomposition) {}
+        decomposition(niceDecomposition),
+        threadCount(std::max(1u, std::thread::hardware_concurrency())) {}
+    virtual ~Solver() = default;
     virtual Graph solve() = 0;
 
+    void setThreadCount(unsigned count);
+
 protected:
+    ThreadPool &getPool();
+
+    /**
+     * Calls solveNode for every node of the nice decomposition, children always before their
+     * parent. Independent subtrees, such as both branches of a JOIN, are processed concurrently.
+     */
+    void solveBottomUp(const std::function<void(unsigned)> &solveNode);
+
     const Graph &graph;
     const TreeDecomposition &decomposition;
+    unsigned threadCount;
+
+private:
+    std::unique_ptr<ThreadPool> pool;
 };
 
 #endif //PACE2018_SOLVER_H
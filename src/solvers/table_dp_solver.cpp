@@ -4,16 +4,18 @@ Graph TableDPSolver::solve() {
     initializeDP();
     globalTerminal = graph.getTerminals()[0];
 
-    for (unsigned i = decomposition.getNodeCount(); i > 0; i--) {
-        solveForNode(i - 1);
-    }
+    solveBottomUp([this](unsigned nodeId) {
+        solveForNode(nodeId);
+    });
     unsigned result = getFromCache(0, 1, 0);
 
     // TODO: non-temporary output
     std::cout << "VALUE " << result << std::endl;
     backtrack(0, 1, 0);
     for (auto edge : resultEdges) {
-        std::cout << edge.first + 1 << " " << edge.second + 1 << std::endl;
+        for (auto original : graph.expandEdge(edge)) {
+            std::cout << original.first + 1 << " " << original.second + 1 << std::endl;
+        }
     }
 
     /*
@@ -27,11 +29,13 @@ Graph TableDPSolver::solve() {
     return Graph();
 }
 
+void TableDPSolver::setJoinEngine(JoinEngine engine) {
+    joinEngine = engine;
+}
+
 void TableDPSolver::initializeDP() {
     unsigned treeNodes = decomposition.getNodeCount();
     dpCache.resize(treeNodes);
-    dpBacktrack.resize(treeNodes);
-    joinBacktrack.resize(treeNodes);
     for (unsigned i = 0; i < treeNodes; ++i) {
         auto bagSize = decomposition.getBagOf(i).size();
         // 64b variable insufficient for partitions
@@ -40,47 +44,47 @@ void TableDPSolver::initializeDP() {
         }
 
         dpCache[i].resize(1u << bagSize);
-        dpBacktrack[i].resize(1u << bagSize);
-        joinBacktrack[i].resize(1u << bagSize);
     }
     resultEdges.clear();
 }
 
 void TableDPSolver::backtrack(int treeNode, unsigned subset, uint64_t partition) {
-    TreeDecomposition::Node node = decomposition.getNodeAt(treeNode);
-    // printDPState(node, treeNode, subset, partition);
+    // explicit stack of states to visit, the nice tree can be far deeper than the call stack allows
+    std::vector<backtrackEntry> stack = {{treeNode, subset, partition}};
+    while (!stack.empty()) {
+        backtrackEntry state = stack.back();
+        stack.pop_back();
 
-    if (node.type == TreeDecomposition::LEAF) {
-        return;
-    }
-    backtrackEntry next = dpBacktrack[treeNode][subset][partition], join = {-1, 0, 0};
-    if (node.type == TreeDecomposition::JOIN) {
-        join = joinBacktrack[treeNode][subset][partition];
-    }
-    switch (node.type) {
-        case TreeDecomposition::INTRO:
-        case TreeDecomposition::FORGET:
-            backtrack(next.nodeId, next.subset, next.partition);
-            break;
+        TreeDecomposition::Node node = decomposition.getNodeAt(state.nodeId);
+        // printDPState(node, state.nodeId, state.subset, state.partition);
 
-        case TreeDecomposition::JOIN:
-            backtrack(next.nodeId, next.subset, next.partition);
-            backtrack(join.nodeId, join.subset, join.partition);
-            break;
+        if (node.type == TreeDecomposition::LEAF) {
+            continue;
+        }
+        stateBacktrack bt;
+        solveForPartition(node, state.nodeId, state.subset, state.partition, bt);
+        switch (node.type) {
+            case TreeDecomposition::INTRO:
+            case TreeDecomposition::FORGET:
+                stack.push_back(bt.next);
+                break;
 
-        case TreeDecomposition::INTRO_EDGE:
-            if (next.partition != partition) {
-                resultEdges.push_back(node.associatedEdge);
-            }
-            backtrack(next.nodeId, next.subset, next.partition);
-            break;
+            case TreeDecomposition::JOIN:
+                stack.push_back(bt.join);
+                stack.push_back(bt.next);
+                break;
 
-        case TreeDecomposition::LEAF:
-            break;
+            case TreeDecomposition::INTRO_EDGE:
+                if (bt.next.partition != state.partition) {
+                    resultEdges.push_back(node.associatedEdge);
+                }
+                stack.push_back(bt.next);
+                break;
 
-        default:
-            std::cerr << "Error, decomposition not nice!" << std::endl;
-            exit(1);
+            default:
+                std::cerr << "Error, decomposition not nice!" << std::endl;
+                exit(1);
+        }
     }
 }
 
@@ -88,68 +92,62 @@ void TableDPSolver::solveForNode(unsigned nodeId) {
     TreeDecomposition::Node node = decomposition.getNodeAt(nodeId);
 
     // find all subsets, terminals always stay on
-    unsigned termMask = 0, termCount = 0, varCount = 0;
-    for (unsigned i = 0; i < node.bag.size(); i++) {
-        if (graph.isTerm(node.bag[i])) {
-            termMask |= 1u << i;
-            termCount++;
-        } else {
-            varCount++;
-        }
-    }
+    unsigned termMask = node.index.termMask, termCount = (unsigned)__builtin_popcount(termMask),
+            varCount = (unsigned)node.bag.size() - termCount;
 
-    // iterate over subsets of variable nodes
-    for (unsigned varSubset = 0; varSubset < (1u << varCount); varSubset++) {
+    // iterate over subsets of variable nodes, each of them only writes its own table
+    getPool().parallelFor(0, 1u << varCount, [&](unsigned varSubset) {
         // scatter variables to the full subset
-        unsigned subset = 0, varIdx = 0;
-        for (unsigned i = 0; i < varCount + termCount; i++) {
-            if ((termMask & (1u << i)) != 0) {
-                subset |= (1u << i);
-            } else {
-                if ((varSubset & (1u << varIdx)) != 0) {
-                    subset |= (1u << i);
-                }
-                varIdx++;
-            }
-        }
-
+        unsigned subset = termMask | depositBits(varSubset, ~termMask & lowBits(varCount + termCount));
         solveForSubset(nodeId, subset);
-    }
+    });
 }
 
 void TableDPSolver::solveForSubset(unsigned nodeId, unsigned subset) {
     TreeDecomposition::Node node = decomposition.getNodeAt(nodeId);
 
-    // generate all feasible partitions
-    uint64_t basePartition = 0;
-    Partitioner partitioner(basePartition, subset, (unsigned)node.bag.size());
-    partitioner.compute();
-    const std::vector<uint64_t>& partitions = partitioner.getResult();
+    auto members = (unsigned)__builtin_popcount(subset);
+    std::vector<unsigned> &table = dpCache[nodeId][subset];
+    if (node.type == TreeDecomposition::JOIN && joinEngine == JoinEngine::FORWARD) {
+        // both children share the subset, their tables are merged pair by pair
+        const int *children = node.index.children;
+        ForwardJoin join(dpCache[children[0]][subset], dpCache[children[1]][subset], members, INFTY);
+        join.compute();
+        table = join.getResult();
+        return;
+    }
 
-    for (auto part : partitions) {
-        solveForPartition(node, nodeId, subset, part);
+    // every canonical partition has its slot, small bags take them straight from the catalogue
+    bool small = node.bag.size() <= PartitionCatalogue::MAX_SIZE;
+    table.resize(partitionCount(members));
+
+    stateBacktrack bt;
+    for (uint64_t rank = 0; rank < table.size(); rank++) {
+        uint64_t compressed = small ? catalogue.partitionAt(members, (unsigned)rank) : unrankPartition(rank, members);
+        table[rank] = solveForPartition(node, nodeId, subset, expandPartition(compressed, subset), bt);
     }
 }
 
-void TableDPSolver::solveForPartition(TreeDecomposition::Node &node,
-                                       int nodeId, unsigned subset, uint64_t partition) {
+unsigned TableDPSolver::solveForPartition(TreeDecomposition::Node &node,
+                                           int nodeId, unsigned subset, uint64_t partition, stateBacktrack &bt) {
     unsigned result;
+    bt = {{-1, 0, 0}, {-1, 0, 0}};
 //    clock_t startClock = clock();
     switch (node.type) {
         case TreeDecomposition::INTRO:
-            result = resolveIntroNode(node, nodeId, subset, partition);
+            result = resolveIntroNode(node, nodeId, subset, partition, bt);
 //            introTime += (clock() - startClock);
             break;
         case TreeDecomposition::FORGET:
-            result = resolveForgetNode(node, nodeId, subset, partition);
+            result = resolveForgetNode(node, nodeId, subset, partition, bt);
 //            forgetTime += (clock() - startClock);
             break;
         case TreeDecomposition::JOIN:
-            result = resolveJoinNode(node, nodeId, subset, partition);
+            result = resolveJoinNode(node, nodeId, subset, partition, bt);
 //            joinTime += (clock() - startClock);
             break;
         case TreeDecomposition::INTRO_EDGE:
-            result = resolveEdgeNode(node, nodeId, subset, partition);
+            result = resolveEdgeNode(node, nodeId, subset, partition, bt);
 //            edgeTime += (clock() - startClock);
             break;
         case TreeDecomposition::LEAF:
@@ -160,95 +158,92 @@ void TableDPSolver::solveForPartition(TreeDecomposition::Node &node,
             std::cerr << "Error, decomposition not nice!" << std::endl;
             exit(1);
     }
-    dpCache[nodeId][subset][partition] = result;
+    return result;
 }
 
 unsigned TableDPSolver::getFromCache(int nodeId, unsigned subset, uint64_t partition) {
-    if (dpCache[nodeId][subset].count(partition) != 0) {
-        return dpCache[nodeId][subset][partition];
+    // tables of subsets without all the terminals stay empty
+    const std::vector<unsigned> &table = dpCache[nodeId][subset];
+    if (table.empty()) {
+        return INFTY;
     }
-    return INFTY;
+    return table[rankPartition(compressPartition(partition, subset), (unsigned)__builtin_popcount(subset))];
 }
 
-unsigned TableDPSolver::resolveIntroNode(TreeDecomposition::Node &node,
-                                 int treeNode, unsigned subset, uint64_t partition) {
+unsigned TableDPSolver::resolveIntroNode(TreeDecomposition::Node &node, int treeNode,
+                                         unsigned subset, uint64_t partition, stateBacktrack &bt) {
     // get child id
-    int child = 0;
-    for (auto adj : node.adjacent) {
-        if (adj < treeNode) {
-            continue;
-        }
-        child = adj;
-    }
+    int child = node.index.children[0];
 
     // process introduced node
     int introduced = node.associatedNode;
-    unsigned idOfIntro = 0;
-    while (node.bag[idOfIntro] != introduced) {
-        idOfIntro++;
-    }
+    unsigned idOfIntro = node.index.position;
 
     // check if we are introducing the global terminal
     if (introduced == globalTerminal) {
-        dpBacktrack[treeNode][subset][partition] = {child, subset, partition};
+        bt.next = {child, subset, partition};
         return getFromCache(child, subset, partition);
     }
 
-    std::vector<char> vParts = partitionToVec((int)node.bag.size(), partition);
-    // if the element is in used subset
-    if ((subset & (1u << idOfIntro)) != 0) {
-        // has to be alone in its partition
-        for (unsigned i = 0; i < vParts.size(); ++i) {
-            if (i != idOfIntro && vParts[i] == vParts[idOfIntro]) {
+    unsigned newMask = maskWithoutElement(subset, idOfIntro, (int)node.bag.size());
+    uint64_t newPartition;
+    if (node.bag.size() <= PartitionCatalogue::MAX_SIZE) {
+        auto members = (unsigned)__builtin_popcount(subset);
+        unsigned index = catalogue.indexOf(members, compressPartition(partition, subset));
+        // if the element is in used subset, it has to be alone in its partition
+        if ((subset & (1u << idOfIntro)) != 0) {
+            auto at = (unsigned)__builtin_popcount(subset & lowBits(idOfIntro));
+            if (!catalogue.isSingleton(members, at, index)) {
                 return INFTY;
             }
+            index = catalogue.erased(members--, at, index);
+        }
+        newPartition = expandPartition(catalogue.partitionAt(members, index), newMask);
+    } else {
+        // if the element is in used subset
+        if ((subset & (1u << idOfIntro)) != 0) {
+            // has to be alone in its partition
+            int introducedComponent = getComponentAt(partition, idOfIntro);
+            for (unsigned i = 0; i < node.bag.size(); ++i) {
+                if (i != idOfIntro && isInSubset(i, subset) && getComponentAt(partition, i) == introducedComponent) {
+                    return INFTY;
+                }
+            }
         }
-    }
 
-    // prepare new partitions
-    unsigned newMask = maskWithoutElement(subset, idOfIntro, (int)node.bag.size());
-    uint64_t newPartition = partitionWithoutElement(vParts, idOfIntro, newMask);
+        // prepare new partitions
+        newPartition = canonizePartition(eraseComponentAt(partition, idOfIntro, (unsigned)node.bag.size()),
+                                         newMask, (unsigned)node.bag.size() - 1);
+    }
 
     // get the solution from the child
     unsigned result = getFromCache(child, newMask, newPartition);
-    dpBacktrack[treeNode][subset][partition] = {child, newMask, newPartition};
+    bt.next = {child, newMask, newPartition};
     return result;
 }
 
-unsigned TableDPSolver::resolveForgetNode(TreeDecomposition::Node &node,
-                                           int treeNode, unsigned int subset, uint64_t partition) {
+unsigned TableDPSolver::resolveForgetNode(TreeDecomposition::Node &node, int treeNode,
+                                          unsigned int subset, uint64_t partition, stateBacktrack &bt) {
     // get the singular child
-    int child = 0;
-    for (auto adj : node.adjacent) {
-        if (adj < treeNode) {
-            continue;
-        }
-        child = adj;
-    }
-    const TreeDecomposition::Node &childNode = decomposition.getNodeAt(child);
+    int child = node.index.children[0];
 
     // get id of the forgotten node in child
-    int forgotten = node.associatedNode, forgottenId = 0;
+    int forgotten = node.associatedNode, forgottenId = (int)node.index.position;
     if (forgotten == globalTerminal) {
-        dpBacktrack[treeNode][subset][partition] = {child, subset, partition};
+        bt.next = {child, subset, partition};
         return getFromCache(child, subset, partition);
     }
-    while (childNode.bag[forgottenId] != forgotten) {
-        forgottenId++;
-    }
 
     unsigned newMask, bestMask = 0;
     uint64_t newPartition = 0, bestPartition = 0;
     unsigned result = INFTY;
-    std::vector<char> vPartition = partitionToVec((int)node.bag.size(), partition),
-            newVPartition;
+    auto size = (unsigned)node.bag.size();
 
     // case, where we didn't use the forgotten node
     if (!graph.isTerm(forgotten)) {
         newMask = maskWithElement(subset, (unsigned)forgottenId, 0, (int) node.bag.size());
-        newVPartition = vPartition;
-        newVPartition.insert(newVPartition.begin() + forgottenId, 0);
-        newPartition = vecToPartition(newVPartition, newMask);
+        newPartition = canonizePartition(insertComponentAt(partition, (unsigned)forgottenId, 0, size),
+                                         newMask, size + 1);
         result = getFromCache(child, newMask, newPartition);
 
         // keep track of the best solution for backtrack
@@ -258,11 +253,18 @@ unsigned TableDPSolver::resolveForgetNode(TreeDecomposition::Node &node,
 
     // case, where we used the forgotten node
     newMask = maskWithElement(subset, (unsigned)forgottenId, 1, (int)node.bag.size());
-    int maxPartitionId = *std::max_element(vPartition.begin(), vPartition.end());
-    for (char part = 0; part < maxPartitionId + 1; part++) {
-        newVPartition = vPartition;
-        newVPartition.insert(newVPartition.begin() + forgottenId, part);
-        newPartition = vecToPartition(newVPartition, newMask);
+    int maxPartitionId = maxComponentIn(partition, size);
+    bool small = size + 1 <= PartitionCatalogue::MAX_SIZE;
+    auto members = (unsigned)__builtin_popcount(subset), at = (unsigned)__builtin_popcount(subset & lowBits(forgottenId));
+    unsigned index = small ? catalogue.indexOf(members, compressPartition(partition, subset)) : 0;
+    for (unsigned part = 0; part < (unsigned)maxPartitionId + 1; part++) {
+        if (small) {
+            newPartition = expandPartition(catalogue.partitionAt(members + 1, catalogue.inserted(members, at, part, index)),
+                                           newMask);
+        } else {
+            newPartition = canonizePartition(insertComponentAt(partition, (unsigned)forgottenId, part, size),
+                                             newMask, size + 1);
+        }
 
         unsigned candidate = getFromCache(child, newMask, newPartition);
         if (result > candidate) {
@@ -272,31 +274,20 @@ unsigned TableDPSolver::resolveForgetNode(TreeDecomposition::Node &node,
         }
     }
 
-    dpBacktrack[treeNode][subset][partition] = {child, bestMask, bestPartition};
+    bt.next = {child, bestMask, bestPartition};
     return result;
 }
 
-unsigned TableDPSolver::resolveJoinNode(TreeDecomposition::Node &node,
-                                         int treeNode, unsigned int subset, uint64_t partition) {
+unsigned TableDPSolver::resolveJoinNode(TreeDecomposition::Node &node, int treeNode,
+                                        unsigned int subset, uint64_t partition, stateBacktrack &bt) {
     // get children IDs
-    int children[2], childPtr = 0;
-    for (auto adj : node.adjacent) {
-        if (adj < treeNode) {
-            continue;
-        }
-        children[childPtr++] = adj;
-    }
-
-    // find possible partitions
-    auto bagSize = node.bag.size();
-    Partitioner partitioner(partition, subset, (int)bagSize);
-    partitioner.compute();
-    const std::vector<uint64_t> &subpartitions = partitioner.getResult();
+    const int *children = node.index.children;
 
     struct partitionResult {
         unsigned result;
         int compCount;
         uint64_t assocPartition;
+        unsigned index;
     };
 
     // precompute component counts
@@ -304,11 +295,28 @@ unsigned TableDPSolver::resolveJoinNode(TreeDecomposition::Node &node,
     std::vector<partitionResult> results1, results2;
     std::vector<unsigned> compResults1, compResults2;
 
-    // prefetch results
-    for (auto i : subpartitions) {
-        int compCount = maxComponentIn(i, (unsigned)bagSize) + 1;
-        results1.push_back({getFromCache(children[0], subset, i), compCount, i});
-        results2.push_back({getFromCache(children[1], subset, i), compCount, i});
+    // find possible partitions and prefetch results, small bags have the refinements and merges tabulated
+    auto bagSize = node.bag.size();
+    bool small = bagSize <= PartitionCatalogue::MAX_JOIN_SIZE;
+    auto members = (unsigned)__builtin_popcount(subset);
+    unsigned index = 0;
+    if (small) {
+        index = catalogue.indexOf(members, compressPartition(partition, subset));
+        auto refinements = catalogue.refinements(members, index);
+        for (auto it = refinements.first; it != refinements.second; ++it) {
+            uint64_t refinement = expandPartition(catalogue.partitionAt(members, *it), subset);
+            int compCount = (int)catalogue.blockCount(members, *it);
+            results1.push_back({getFromCache(children[0], subset, refinement), compCount, refinement, *it});
+            results2.push_back({getFromCache(children[1], subset, refinement), compCount, refinement, *it});
+        }
+    } else {
+        Partitioner partitioner(partition, subset, (int)bagSize);
+        partitioner.compute();
+        for (auto i : partitioner.getResult()) {
+            int compCount = maxComponentIn(i, (unsigned)bagSize) + 1;
+            results1.push_back({getFromCache(children[0], subset, i), compCount, i, 0});
+            results2.push_back({getFromCache(children[1], subset, i), compCount, i, 0});
+        }
     }
 
     // sort partitions by result
@@ -343,7 +351,8 @@ unsigned TableDPSolver::resolveJoinNode(TreeDecomposition::Node &node,
             if (activeNodes != p1.compCount + p2.compCount - partCompCount) {
                 continue;
             }
-            if (merger.merge(p1.assocPartition, p2.assocPartition) != partition) {
+            if (small ? catalogue.joined(members, p1.index, p2.index) != index
+                      : merger.merge(p1.assocPartition, p2.assocPartition) != partition) {
                 continue;
             }
             result = candidate;
@@ -354,44 +363,28 @@ unsigned TableDPSolver::resolveJoinNode(TreeDecomposition::Node &node,
     }
 
     // write backtrack info about both branches
-    dpBacktrack[treeNode][subset][partition] = {children[0], subset, bestP1};
-    joinBacktrack[treeNode][subset][partition] = {children[1], subset, bestP2};
+    bt.next = {children[0], subset, bestP1};
+    bt.join = {children[1], subset, bestP2};
     return result;
 }
 
-unsigned TableDPSolver::resolveEdgeNode(TreeDecomposition::Node &node,
-                                         int treeNode, unsigned int subset, uint64_t partition) {
-    // get both endpoints of the new edge
-    int intro1 = node.associatedEdge.first,
-            intro2 = node.associatedEdge.second;
-
+unsigned TableDPSolver::resolveEdgeNode(TreeDecomposition::Node &node, int treeNode,
+                                        unsigned int subset, uint64_t partition, stateBacktrack &bt) {
     // get both edge endpoint ids
-    unsigned end1id = 0, end2id = 0;
-    while (node.bag[end1id] != intro1) {
-        end1id++;
-    }
-    while (node.bag[end2id] != intro2) {
-        end2id++;
-    }
+    unsigned end1id = node.index.edgePositions[0], end2id = node.index.edgePositions[1];
 
     // find the singular child
-    int child = 0;
-    for (auto adj : node.adjacent) {
-        if (adj < treeNode) {
-            continue;
-        }
-        child = adj;
-    }
+    int child = node.index.children[0];
 
     // if one of them is not in the selected subset
     if (!isInSubset(end1id, subset) || !isInSubset(end2id, subset)) {
-        dpBacktrack[treeNode][subset][partition] = {child, subset, partition};
+        bt.next = {child, subset, partition};
         return getFromCache(child, subset, partition);
     }
 
     // if they are in separate partitions
     if (getComponentAt(partition, end1id) != getComponentAt(partition, end2id)) {
-        dpBacktrack[treeNode][subset][partition] = {child, subset, partition};
+        bt.next = {child, subset, partition};
         return getFromCache(child, subset, partition);
     }
 
@@ -400,33 +393,49 @@ unsigned TableDPSolver::resolveEdgeNode(TreeDecomposition::Node &node,
     uint64_t bestPartition = partition;
 
     // setup variables for the cases where the edge is used
-    std::vector<char> vPartition = partitionToVec((int)node.bag.size(), partition);
-    int maxPartitionId = *std::max_element(vPartition.begin(), vPartition.end());
-    int edgeWeight = graph.getAdjacentOf(intro1).at(intro2);
+    int maxPartitionId = maxComponentIn(partition, (unsigned)node.bag.size());
+    int edgeWeight = (int)node.index.edgeWeight;
 
     // iterate over all possible partitions, where edge ends are disconnected
+    if (node.bag.size() <= PartitionCatalogue::MAX_SIZE) {
+        auto members = (unsigned)__builtin_popcount(subset);
+        auto splits = catalogue.splits(members, (unsigned)__builtin_popcount(subset & lowBits(end1id)),
+                                       (unsigned)__builtin_popcount(subset & lowBits(end2id)),
+                                       catalogue.indexOf(members, compressPartition(partition, subset)));
+        for (auto it = splits.first; it != splits.second; ++it) {
+            uint64_t newPartition = expandPartition(catalogue.partitionAt(members, *it), subset);
+            unsigned candidate = getFromCache(child, subset, newPartition);
+            if (result > candidate + edgeWeight) {
+                result = candidate + edgeWeight;
+                bestPartition = newPartition;
+            }
+        }
+
+        bt.next = {child, subset, bestPartition};
+        return result;
+    }
 
     std::vector<int> edgePartitionIds;
     for (unsigned i = 0; i < node.bag.size(); i++) {
-        if (vPartition[i] == vPartition[end1id] && isInSubset(i, subset)) {
+        if (getComponentAt(partition, i) == getComponentAt(partition, end1id) && isInSubset(i, subset)) {
             edgePartitionIds.push_back(i);
         }
     }
     auto edgePartitionSize = edgePartitionIds.size();
 
     for (unsigned option = 0; option < (1u << edgePartitionSize); option++) {
-        std::vector<char> newVPartition = vPartition;
+        uint64_t newPartition = partition;
         unsigned ctr = 0;
         for (auto id : edgePartitionIds) {
             if ((option & (1u << ctr++)) != 0) {
                 // set new separate partition
-                newVPartition[id] = (char)(maxPartitionId + 1);
+                setComponentAt(newPartition, id, (unsigned char)(maxPartitionId + 1));
             }
         }
-        if (newVPartition[end1id] == newVPartition[end2id]) {
+        if (getComponentAt(newPartition, end1id) == getComponentAt(newPartition, end2id)) {
             continue;
         }
-        uint64_t newPartition = vecToPartition(newVPartition, subset);
+        newPartition = canonizePartition(newPartition, subset, (unsigned)node.bag.size());
 
         unsigned candidate = getFromCache(child, subset, newPartition);
         if (result > candidate + edgeWeight) {
@@ -435,7 +444,7 @@ unsigned TableDPSolver::resolveEdgeNode(TreeDecomposition::Node &node,
         }
     }
 
-    dpBacktrack[treeNode][subset][partition] = {child, subset, bestPartition};
+    bt.next = {child, subset, bestPartition};
     return result;
 }
 
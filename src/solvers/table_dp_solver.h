@@ -3,10 +3,11 @@
 
 #include <climits>
 #include <ctime>
-#include <unordered_map>
 #include <vector>
 
 #include "solvers/solver.h"
+#include "utility/forward_join.h"
+#include "utility/partition_catalogue.h"
 #include "utility/partitioner.h"
 #include "utility/partition_mergers.h"
 
@@ -14,6 +15,8 @@ class TableDPSolver : public Solver {
 public:
     TableDPSolver(const Graph &inputGraph, const TreeDecomposition &niceDecomposition)
             : Solver(inputGraph, niceDecomposition),
+              catalogue(PartitionCatalogue::get()),
+              joinEngine(JoinEngine::FORWARD),
               globalTerminal(-1),
               introTime(0), forgetTime(0), joinTime(0), edgeTime(0), leafTime(0) {
         INFTY = (UINT_MAX >> 1u) - 10;
@@ -25,37 +28,48 @@ public:
 
     Graph solve() override;
 
+    /**
+     * Forward by default, every state of a subset is computed anyway. Backtracking always takes the
+     * refinements of the single parent state on the solution path.
+     */
+    void setJoinEngine(JoinEngine engine);
+
 private:
     void initializeDP();
     void backtrack(int treeNode, unsigned subset, uint64_t partition);
 
     void solveForNode(unsigned nodeId);
     void solveForSubset(unsigned nodeId, unsigned subset);
-    void solveForPartition(TreeDecomposition::Node &node,
-                           int nodeId, unsigned subset, uint64_t partition);
-
-    unsigned getFromCache(int nodeId, unsigned subset, uint64_t partition);
-
-    unsigned resolveIntroNode(TreeDecomposition::Node &node,
-                              int treeNode, unsigned subset, uint64_t partition);
-    unsigned resolveForgetNode(TreeDecomposition::Node &node,
-                               int treeNode, unsigned int subset, uint64_t partition);
-    unsigned resolveJoinNode(TreeDecomposition::Node &node,
-                             int treeNode, unsigned int subset, uint64_t partition);
-    unsigned resolveEdgeNode(TreeDecomposition::Node &node,
-                             int treeNode, unsigned int subset, uint64_t partition);
-    unsigned resolveLeafNode(unsigned int subset);
-
-    std::vector<std::vector<std::unordered_map<uint64_t, unsigned>>> dpCache;
-
     struct backtrackEntry {
         int nodeId;
         unsigned subset;
         uint64_t partition;
     };
 
-    std::vector<std::vector<std::unordered_map<uint64_t, backtrackEntry>>>
-            dpBacktrack, joinBacktrack;
+    struct stateBacktrack {
+        backtrackEntry next, join;
+    };
+
+    unsigned solveForPartition(TreeDecomposition::Node &node,
+                               int nodeId, unsigned subset, uint64_t partition, stateBacktrack &bt);
+
+    unsigned getFromCache(int nodeId, unsigned subset, uint64_t partition);
+
+    unsigned resolveIntroNode(TreeDecomposition::Node &node, int treeNode,
+                              unsigned subset, uint64_t partition, stateBacktrack &bt);
+    unsigned resolveForgetNode(TreeDecomposition::Node &node, int treeNode,
+                               unsigned int subset, uint64_t partition, stateBacktrack &bt);
+    unsigned resolveJoinNode(TreeDecomposition::Node &node, int treeNode,
+                             unsigned int subset, uint64_t partition, stateBacktrack &bt);
+    unsigned resolveEdgeNode(TreeDecomposition::Node &node, int treeNode,
+                             unsigned int subset, uint64_t partition, stateBacktrack &bt);
+    unsigned resolveLeafNode(unsigned int subset);
+
+    // transitions of bags up to PartitionCatalogue::MAX_SIZE are looked up
+    const PartitionCatalogue &catalogue;
+    JoinEngine joinEngine;
+    // costs indexed by the rank of the partition compressed to its subset, backtracking recomputes the transitions
+    std::vector<std::vector<std::vector<unsigned>>> dpCache;
     std::vector<std::pair<int, int>> resultEdges;
     int globalTerminal;
     unsigned INFTY;
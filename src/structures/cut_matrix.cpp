@@ -1,87 +1,97 @@
 #include "cut_matrix.h"
 
-void CutMatrix::generate(const std::vector<uint64_t> &sortedPartitions,
-                         unsigned subset, unsigned size) {
-    generateCuts(subset, size);
-    for (auto part : sortedPartitions) {
-        transformToRow(part, subset, size);
+// side of the six lowest members over 64 consecutive cuts, higher members keep one side for a whole word
+static const uint64_t LOW_SIDES[6] = {0xAAAAAAAAAAAAAAAA, 0xCCCCCCCCCCCCCCCC, 0xF0F0F0F0F0F0F0F0,
+                                      0xFF00FF00FF00FF00, 0xFFFF0000FFFF0000, 0xFFFFFFFF00000000};
+
+template <typename Partition>
+CutMatrix<Partition>::CutMatrix(unsigned subset, unsigned size) {
+    for (unsigned rest = subset & lowBits(size); rest != 0; rest &= rest - 1) {
+        members.push_back((unsigned)__builtin_ctz(rest));
     }
+    cutCount = members.empty() ? 0 : 1ull << (members.size() - 1);
+    words = (unsigned)((cutCount + 63u) >> 6u);
+    pivotRow.assign(cutCount, -1);
+    row.resize(words);
 }
 
-void CutMatrix::eliminate() {
-    std::vector<Row> basis;
+template <typename Partition>
+bool CutMatrix<Partition>::insert(const Partition &partition) {
+    if (isFull()) {
+        return false;
+    }
+    evaluate(partition, row.data());
 
-    for (unsigned scan = 0; scan < rows.size(); scan++) {
-        int scanLSB = rows[scan].lsb();
-        // zero row
-        if (scanLSB == -1) {
+    // clear pivots of the basis until a new one remains or nothing does
+    for (unsigned word = 0; word < words;) {
+        if (row[word] == 0) {
+            word++;
             continue;
         }
-        basis.push_back(rows[scan]);
-        for (unsigned elim = scan + 1; elim < rows.size(); elim++) {
-            if (rows[elim].at((unsigned)scanLSB)) {
-                rows[elim].add(rows[scan]);
-            }
+        uint64_t pivot = ((uint64_t)word << 6u) + __builtin_ctzll(row[word]);
+        int at = pivotRow[pivot];
+        if (at == -1) {
+            pivotRow[pivot] = (int)partitions.size();
+            basis.insert(basis.end(), row.begin(), row.end());
+            partitions.push_back(partition);
+            return true;
+        }
+        // the basis row is zero below its pivot
+        const uint64_t *other = basis.data() + (size_t)at * words;
+        for (unsigned i = word; i < words; i++) {
+            row[i] ^= other[i];
         }
     }
+    return false;
+}
 
-    rows = basis;
+template <typename Partition>
+bool CutMatrix<Partition>::isFull() const {
+    return partitions.size() == cutCount;
 }
 
-std::vector<uint64_t> CutMatrix::getPartitions() const {
-    std::vector<uint64_t> partitions;
-    for (auto row : rows) {
-        partitions.push_back(row.partition);
-    }
+template <typename Partition>
+const std::vector<Partition> &CutMatrix<Partition>::getPartitions() const {
     return partitions;
 }
 
-void CutMatrix::generateCuts(unsigned subset, unsigned size) {
-    unsigned subsetSize = __builtin_popcount(subset);
-
-    for (unsigned cutSubset = 0; cutSubset < (1u << (subsetSize-1)); cutSubset++) {
-        // scatter bits by mask
-        unsigned cut = 0, ptr = 0;
-        for (unsigned i = 0; i < size; i++) {
-            // skip unused node
-            if (!isInSubset(i, subset)) {
-                continue;
-            }
-            // set bit if it's present in the subset cut
-            if ((cutSubset & (1u << ptr++)) != 0) {
-                cut |= (1u << i);
-            }
-        }
-        cuts.push_back(cut);
+template <typename Partition>
+void CutMatrix<Partition>::evaluate(const Partition &partition, uint64_t *target) const {
+    // member masks of the blocks, components are numbered below the member count
+    unsigned blocks[32] = {}, blockCount = 0;
+    for (unsigned i = 0; i < members.size(); i++) {
+        auto component = (unsigned)getComponentAt(partition, members[i]);
+        blocks[component] |= 1u << i;
+        blockCount = std::max(blockCount, component + 1);
     }
-}
-
-void CutMatrix::transformToRow(uint64_t partition, unsigned subset, unsigned size) {
-    // set size of bitset to ceil(cuts / 64) 64bit integers
-    Row row;
-    row.bset.resize(((cuts.size() + 63u) >> 6u));
-    row.partition = partition;
 
-    for (unsigned cutId = 0; cutId < (unsigned)cuts.size(); cutId++) {
-        if (partitionRefinesCut(partition, cuts[cutId], subset, size)) {
-            row.bset[cutId >> 6u] |= 1ull << (cutId % 64);
+    // the low members decide within a word, where the block is all on one side
+    uint64_t lowOnes[32], lowZeros[32];
+    for (unsigned block = 0; block < blockCount; block++) {
+        lowOnes[block] = lowZeros[block] = ~0ull;
+        for (unsigned rest = blocks[block] & 0x3Fu; rest != 0; rest &= rest - 1) {
+            uint64_t side = LOW_SIDES[__builtin_ctz(rest)];
+            lowOnes[block] &= side;
+            lowZeros[block] &= ~side;
         }
+        blocks[block] >>= 6u;
     }
-    rows.push_back(row);
-}
 
-bool CutMatrix::partitionRefinesCut(uint64_t partition, unsigned cut,
-                                    unsigned subset, unsigned size) {
-    unsigned isInZero = 0, isInOne = 0;
-    for (unsigned i = 0; i < size; i++) {
-        if (!isInSubset(i, subset)) {
-            continue;
-        }
-        if (isInSubset(i, cut)) {
-            isInOne |= 1u << (unsigned)getComponentAt(partition, i);
-        } else {
-            isInZero |= 1u << (unsigned)getComponentAt(partition, i);
+    // the high members are bits of the word index
+    for (unsigned word = 0; word < words; word++) {
+        uint64_t bits = ~0ull;
+        for (unsigned block = 0; block < blockCount; block++) {
+            uint64_t ones = (blocks[block] & ~word) == 0 ? lowOnes[block] : 0,
+                     zeros = (blocks[block] & word) == 0 ? lowZeros[block] : 0;
+            bits &= ones | zeros;
         }
+        target[word] = bits;
+    }
+    if (cutCount < 64) {
+        target[0] &= (1ull << cutCount) - 1;
     }
-    return (isInOne & isInZero) == 0;
 }
+
+template class CutMatrix<uint64_t>;
+template class CutMatrix<uint128_t>;
+template class CutMatrix<std::array<uint64_t, 4>>;
@@ -4,57 +4,47 @@
 #include <cstdint>
 #include <iostream>
 #include <vector>
-#include <unordered_map>
 
 #include "utility/helpers.h"
 
+/**
+ * Rows of partitions against the cuts of the subset, a row basis keeps a representative set of partitions
+ *
+ * The basis grows one partition at a time. A row is reduced against the basis kept so far and only stays
+ * if something remains, so inserting the partitions cheapest first keeps the cheapest representative set.
+ * Cuts put the last member of the subset on the zero side, there are 2^(|subset| - 1) of them and the rank
+ * never exceeds that, after which no further row can be independent.
+ */
+template <typename Partition>
 class CutMatrix {
 public:
-    void generate(const std::vector<uint64_t>& sortedPartitions,
-                  unsigned subset, unsigned size);
+    CutMatrix(unsigned subset, unsigned size);
 
-    void eliminate();
+    /**
+     * Whether the partition was independent of the basis and got added to it
+     */
+    bool insert(const Partition &partition);
 
-    std::vector<uint64_t> getPartitions() const;
+    bool isFull() const;
+
+    const std::vector<Partition> &getPartitions() const;
 
 private:
-    struct Row {
-        std::vector<uint64_t> bset;
-        uint64_t partition;
-
-        Row() : partition(0) {}
-
-        int lsb() {
-            unsigned mul = 0;
-            for (auto i : bset) {
-                if (i != 0) {
-                     return __builtin_ffsll(i) - 1 + (mul << 6u);
-                }
-                mul++;
-            }
-            return -1;
-        };
-
-        void add(const Row& r) {
-            for (unsigned i = 0; i < bset.size(); i++) {
-                bset[i] ^= r.bset[i];
-            }
-        }
-
-        bool at(unsigned idx) {
-            return (bset[idx >> 6u] & (1ull << (idx % 64))) != 0;
-        }
-    };
-
-    void generateCuts(unsigned subset, unsigned size);
-
-    void transformToRow(uint64_t partition, unsigned subset, unsigned size);
-
-    bool partitionRefinesCut(uint64_t partition, unsigned cut,
-                             unsigned subset, unsigned size);
-
-    std::vector<unsigned> cuts;
-    std::vector<Row> rows;
+    /**
+     * Bits of a row for 64 cuts at a time, a block refines a cut when all its members are on one side
+     */
+    void evaluate(const Partition &partition, uint64_t *target) const;
+
+    std::vector<unsigned> members;
+    uint64_t cutCount;
+    unsigned words;
+
+    // reduced rows one after another, the lowest bit of a row is its pivot
+    std::vector<uint64_t> basis;
+    // basis row of each pivot cut, -1 if none
+    std::vector<int> pivotRow;
+    std::vector<uint64_t> row;
+    std::vector<Partition> partitions;
 };
 
 
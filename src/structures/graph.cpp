@@ -1,22 +1,27 @@
 #include "graph.h"
 
 void Graph::load(std::istream &input) {
-    std::string skip;
+    // the graph and terminal sections
+    InputReader reader(input, 2);
+    load(reader);
+}
 
-    input >> skip >> skip; // skip the "SECTION Graph" part
-    input >> skip >> nodeCount;
-    input >> skip >> edgeCount;
+void Graph::load(InputReader &input) {
+    input.readWord(); input.readWord(); // skip the "SECTION Graph" part
+    input.readWord(); nodeCount = (int)input.readInt();
+    input.readWord(); edgeCount = (int)input.readInt();
 
     // setup lists of neighbours
     graph.clear();
     graph.resize((unsigned)nodeCount);
 
     edgeWeightSum = 0;
-    std::set<std::pair<int, int>> edgeSet;
+    edgeList.clear();
+    edgeList.reserve((unsigned)edgeCount);
     for (int i = 0; i < edgeCount; i++) {
-        int vertA = -1, vertB = -1, weight = -1;
-        input >> skip >> vertA >> vertB >> weight;
-        vertA--; vertB--;
+        input.readWord();
+        auto vertA = (int)input.readInt() - 1, vertB = (int)input.readInt() - 1;
+        auto weight = (int)input.readInt();
         // check for multiedges
         if (graph[vertA].count(vertB) != 0) {
             if (graph[vertA][vertB] <= weight) {
@@ -26,33 +31,35 @@ void Graph::load(std::istream &input) {
         graph[vertA][vertB] = weight;
         graph[vertB][vertA] = weight;
         edgeWeightSum += weight;
-        edgeSet.insert(std::minmax(vertA, vertB));
+        edgeList.emplace_back(std::minmax(vertA, vertB));
     }
-    std::copy(edgeSet.begin(), edgeSet.end(), std::back_inserter(edgeList));
-    input >> skip; // END
+    std::sort(edgeList.begin(), edgeList.end());
+    edgeList.erase(std::unique(edgeList.begin(), edgeList.end()), edgeList.end());
+    input.readWord(); // END
 
     // load terminals
-    input >> skip >> skip; // skip the "SECTION Terminals" part
-    input >> skip >> termCount;
+    input.readWord(); input.readWord(); // skip the "SECTION Terminals" part
+    input.readWord(); termCount = (int)input.readInt();
     isTerminal.clear();
     isTerminal.resize((unsigned)nodeCount, false);
     for (int i = 0; i < termCount; i++) {
-        int termId = -1;
-        input >> skip >> termId;
-        termId--;
+        input.readWord();
+        int termId = (int)input.readInt() - 1;
         isTerminal[termId] = true;
         terminals.push_back(termId);
     }
-    input >> skip; // END
+    input.readWord(); // END
 
     // preprocess the graph
     isErased.clear();
     isErased.resize((unsigned)nodeCount, false);
+    substitutes.assign((unsigned)nodeCount, -1);
+    expansion.clear();
     preselectedWeight = 0;
-    cutLeaves();
+    leafCutReport = cutLeaves();
 
     // round up the graph format
-    initEdgeIds();
+    buildCsr();
     std::sort(terminals.begin(), terminals.end());
 }
 
@@ -77,7 +84,21 @@ int Graph::getNodeCount() const {
 }
 
 int Graph::idOfEdge(const std::pair<int, int>& edge) const {
-    return edgeIds.at(edge);
+    int arc = findArc(edge.first, edge.second);
+    return arc == -1 ? edgeIdInList(edge) : csrEdgeIds[arc];
+}
+
+int Graph::findArc(int from, int to) const {
+    auto first = csrTargets.begin() + csrOffsets[from], last = csrTargets.begin() + csrOffsets[from + 1];
+    auto it = std::lower_bound(first, last, to);
+    if (it == last || *it != to) {
+        return -1;
+    }
+    return (int)(it - csrTargets.begin());
+}
+
+int Graph::getEdgeWeight(int from, int to) const {
+    return csrWeights[findArc(from, to)];
 }
 
 std::pair<int, int> Graph::edgeWithId(int id) const {
@@ -93,39 +114,59 @@ bool Graph::isNodeErased(int id) const {
     return isErased[id];
 }
 
-int Graph::getFirstLeaf() {
+Graph::LeafCutReport Graph::cutLeaves() {
+    LeafCutReport report = {0, 0, 0};
+
+    // nodes of degree one, removing one can turn its neighbour into a leaf as well
+    std::vector<int> leaves;
+    int liveTerminals = 0;
     for (int i = 0; i < nodeCount; i++) {
-        if (!isErased[i] && getAdjacentOf(i).size() == 1) {
-            return i;
+        if (!isErased[i] && graph[i].size() == 1) {
+            leaves.push_back(i);
+        }
+        if (!isErased[i] && isTerminal[i]) {
+            liveTerminals++;
         }
     }
-    return -1;
-}
 
-void Graph::cutLeaves() {
-    int leaf = getFirstLeaf();
-    while (leaf != -1) {
+    while (!leaves.empty()) {
+        int leaf = leaves.back();
+        leaves.pop_back();
+        if (isErased[leaf] || graph[leaf].size() != 1) {
+            continue;
+        }
+
         // get ID of the only neighbor
-        int child = (*(getAdjacentOf(leaf).begin())).first;
+        int child = (*(graph[leaf].begin())).first;
 
-        // case when the leaf is terminal
+        // case when the leaf is terminal, the last one must stay as there is nothing to connect it to
         if (isTerm(leaf)) {
+            if (liveTerminals == 1) {
+                continue;
+            }
             if (!isTerm(child)) {
                 isTerminal[child] = true;
                 terminals.push_back(child);
+            } else {
+                liveTerminals--;
             }
-            preselectedEdges.emplace_back(std::minmax(leaf, child));
-            preselectedWeight += graph[child][leaf];
+            report.preselectedWeight += graph[child][leaf];
+            preselect(leaf, child);
         }
 
         // cut the node from the graph
         graph[child].erase(leaf);
         isErased[leaf] = true;
+        report.removedNodes++;
+        report.removedEdges++;
 
-        leaf = getFirstLeaf();
+        if (graph[child].size() == 1) {
+            leaves.push_back(child);
+        }
     }
 
     recomputeStatistics();
+    return report;
 }
 
 void Graph::recomputeStatistics() {
@@ -156,12 +197,397 @@ int Graph::getPreselectedWeight() const {
     return preselectedWeight;
 }
 
-void Graph::initEdgeIds() {
-    int currEdgeId = 0;
-    for (auto edge : edgeList) {
-        if (edgeIds.count(edge) == 0) {
-            edgeIds[edge] = currEdgeId++;
+const Graph::LeafCutReport &Graph::getLeafCutReport() const {
+    return leafCutReport;
+}
+
+int Graph::edgeIdInList(const std::pair<int, int> &edge) const {
+    // the edge list is sorted and free of duplicates, ids are the positions in it
+    auto it = std::lower_bound(edgeList.begin(), edgeList.end(), edge);
+    if (it == edgeList.end() || *it != edge) {
+        return -1;
+    }
+    return (int)(it - edgeList.begin());
+}
+
+
+void Graph::buildCsr() {
+    csrOffsets.assign((unsigned)nodeCount + 1, 0);
+    for (int i = 0; i < nodeCount; i++) {
+        csrOffsets[i + 1] = csrOffsets[i] + (isErased[i] ? 0 : (unsigned)graph[i].size());
+    }
+
+    unsigned arcCount = csrOffsets[nodeCount];
+    csrTargets.resize(arcCount);
+    csrWeights.resize(arcCount);
+    csrEdgeIds.resize(arcCount);
+    for (int i = 0; i < nodeCount; i++) {
+        if (isErased[i]) {
+            continue;
         }
+        // rows come out sorted, as the maps are ordered by neighbour
+        unsigned arc = csrOffsets[i];
+        for (auto adj : graph[i]) {
+            csrTargets[arc] = adj.first;
+            csrWeights[arc] = adj.second;
+            csrEdgeIds[arc] = edgeIdInList(std::minmax(i, adj.first));
+            arc++;
+        }
+    }
+}
+
+void Graph::preselect(int from, int to) {
+    preselectedWeight += graph[from][to];
+    for (auto edge : expandEdge({from, to})) {
+        preselectedEdges.push_back(edge);
     }
 }
 
+std::vector<std::pair<int, int>> Graph::expandEdge(const std::pair<int, int> &edge) const {
+    std::pair<int, int> key = std::minmax(edge.first, edge.second);
+    auto it = expansion.find(key);
+    if (it == expansion.end()) {
+        return {key};
+    }
+    return it->second;
+}
+
+int Graph::substituteOf(int node) const {
+    while (isErased[node] && substitutes[node] != -1) {
+        node = substitutes[node];
+    }
+    return isErased[node] ? -1 : node;
+}
+
+void Graph::reduce() {
+    // reductions enable each other, repeat while something changes, up to a few rounds
+    const int maxRounds = 8;
+    for (int round = 0; round < maxRounds; round++) {
+        bool changed = contractDegreeTwo();
+        changed |= deleteLongEdges();
+        changed |= deleteDegreeThree();
+        changed |= contractNearestVertices();
+
+        LeafCutReport report = cutLeaves();
+        leafCutReport.removedNodes += report.removedNodes;
+        leafCutReport.removedEdges += report.removedEdges;
+        leafCutReport.preselectedWeight += report.preselectedWeight;
+        if (!changed && report.removedNodes == 0) {
+            break;
+        }
+    }
+
+    rebuild();
+}
+
+void Graph::setEdge(int from, int to, int weight, std::vector<std::pair<int, int>> path) {
+    graph[from][to] = weight;
+    graph[to][from] = weight;
+    std::pair<int, int> key = std::minmax(from, to);
+    if (path.size() == 1 && path[0] == key) {
+        expansion.erase(key);
+    } else {
+        expansion[key] = std::move(path);
+    }
+}
+
+void Graph::removeEdge(int from, int to) {
+    graph[from].erase(to);
+    graph[to].erase(from);
+    expansion.erase(std::minmax(from, to));
+}
+
+void Graph::eraseNode(int node, int substitute) {
+    std::vector<int> neighbours;
+    for (auto adj : graph[node]) {
+        neighbours.push_back(adj.first);
+    }
+    for (auto adj : neighbours) {
+        removeEdge(node, adj);
+    }
+    isErased[node] = true;
+    substitutes[node] = substitute;
+}
+
+void Graph::boundedSearch(int source, unsigned bound, int avoidNode, const std::pair<int, int> &avoidEdge,
+                          const std::function<bool(int, unsigned)> &visit) {
+    // the searches only need to look around locally, cap their size to keep the reductions linear
+    const unsigned settleLimit = 256;
+    const unsigned unreached = std::numeric_limits<unsigned>::max();
+    searchDist.resize((unsigned)nodeCount, unreached);
+
+    std::vector<int> touched = {source};
+    std::priority_queue<std::pair<unsigned, int>, std::vector<std::pair<unsigned, int>>,
+            std::greater<std::pair<unsigned, int>>> queue;
+    searchDist[source] = 0;
+    queue.push({0, source});
+    unsigned settled = 0;
+    while (!queue.empty() && settled < settleLimit) {
+        std::pair<unsigned, int> curr = queue.top();
+        queue.pop();
+        if (curr.first != searchDist[curr.second]) {
+            continue;
+        }
+        settled++;
+        if (visit(curr.second, curr.first)) {
+            break;
+        }
+        for (auto adj : graph[curr.second]) {
+            std::pair<int, int> edge = std::minmax(curr.second, adj.first);
+            if (adj.first == avoidNode || edge == avoidEdge) {
+                continue;
+            }
+            unsigned candidate = curr.first + adj.second;
+            if (candidate <= bound && candidate < searchDist[adj.first]) {
+                if (searchDist[adj.first] == unreached) {
+                    touched.push_back(adj.first);
+                }
+                searchDist[adj.first] = candidate;
+                queue.push({candidate, adj.first});
+            }
+        }
+    }
+
+    for (auto node : touched) {
+        searchDist[node] = unreached;
+    }
+}
+
+bool Graph::contractDegreeTwo() {
+    bool changed = false;
+    for (int node = 0; node < nodeCount; node++) {
+        if (isErased[node] || isTerminal[node] || graph[node].size() != 2) {
+            continue;
+        }
+        auto it = graph[node].begin();
+        std::pair<int, int> first = *it, second = *(++it);
+        int weight = first.second + second.second;
+
+        // an existing edge at least as short makes the path useless
+        if (graph[first.first].count(second.first) != 0 && graph[first.first][second.first] <= weight) {
+            eraseNode(node, -1);
+            changed = true;
+            continue;
+        }
+
+        std::vector<std::pair<int, int>> path = expandEdge({node, first.first});
+        for (auto edge : expandEdge({node, second.first})) {
+            path.push_back(edge);
+        }
+        eraseNode(node, first.first);
+        setEdge(first.first, second.first, weight, std::move(path));
+        changed = true;
+    }
+    return changed;
+}
+
+bool Graph::deleteLongEdges() {
+    bool changed = false;
+    for (int node = 0; node < nodeCount; node++) {
+        if (isErased[node]) {
+            continue;
+        }
+        std::vector<std::pair<int, int>> candidates(graph[node].begin(), graph[node].end());
+        for (auto adj : candidates) {
+            if (adj.first < node) {
+                continue;
+            }
+            // the edge is not needed if another path is not longer
+            bool replaceable = false;
+            boundedSearch(node, (unsigned)adj.second, -1, std::minmax(node, adj.first),
+                          [&](int reached, unsigned) {
+                              replaceable = reached == adj.first;
+                              return replaceable;
+                          });
+            if (replaceable) {
+                removeEdge(node, adj.first);
+                changed = true;
+            }
+        }
+    }
+    return changed;
+}
+
+bool Graph::deleteDegreeThree() {
+    bool changed = false;
+    for (int node = 0; node < nodeCount; node++) {
+        if (isErased[node] || isTerminal[node] || graph[node].size() != 3) {
+            continue;
+        }
+        std::vector<std::pair<int, int>> adj(graph[node].begin(), graph[node].end());
+
+        // distances between the neighbours avoiding the node, bounded by the paths through it
+        unsigned dist[3][3] = {};
+        bool ok = true;
+        for (int a = 0; a < 2 && ok; a++) {
+            unsigned bound = 0;
+            for (int b = a + 1; b < 3; b++) {
+                bound = std::max(bound, (unsigned)(adj[a].second + adj[b].second));
+            }
+            for (int b = a + 1; b < 3; b++) {
+                dist[a][b] = std::numeric_limits<unsigned>::max();
+            }
+            boundedSearch(adj[a].first, bound, node, {-1, -1}, [&](int reached, unsigned distance) {
+                for (int b = a + 1; b < 3; b++) {
+                    if (reached == adj[b].first) {
+                        dist[a][b] = distance;
+                    }
+                }
+                return false;
+            });
+            for (int b = a + 1; b < 3; b++) {
+                ok &= dist[a][b] <= (unsigned)(adj[a].second + adj[b].second);
+            }
+        }
+        if (!ok) {
+            continue;
+        }
+
+        // using all three edges must not be cheaper than connecting the neighbours by two paths
+        unsigned pairs[3] = {dist[0][1], dist[0][2], dist[1][2]};
+        std::sort(pairs, pairs + 3);
+        if (pairs[0] + pairs[1] <= (unsigned)(adj[0].second + adj[1].second + adj[2].second)) {
+            eraseNode(node, -1);
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+bool Graph::contractNearestVertices() {
+    bool changed = false;
+    int liveTerminals = 0;
+    for (int i = 0; i < nodeCount; i++) {
+        liveTerminals += (!isErased[i] && isTerminal[i]) ? 1 : 0;
+    }
+
+    for (int term = 0; term < nodeCount && liveTerminals > 1; term++) {
+        if (isErased[term] || !isTerminal[term] || graph[term].size() < 2) {
+            continue;
+        }
+        // two shortest edges of the terminal
+        std::pair<int, int> nearest = {-1, std::numeric_limits<int>::max()};
+        int secondWeight = std::numeric_limits<int>::max();
+        for (auto adj : graph[term]) {
+            if (adj.second < nearest.second) {
+                secondWeight = nearest.second;
+                nearest = adj;
+            } else if (adj.second < secondWeight) {
+                secondWeight = adj.second;
+            }
+        }
+
+        // the shortest edge is in some optimal tree, if the nearest vertex is close to another terminal
+        bool contractible = false;
+        boundedSearch(nearest.first, (unsigned)(secondWeight - nearest.second), term, {-1, -1},
+                      [&](int reached, unsigned) {
+                          contractible = isTerminal[reached];
+                          return contractible;
+                      });
+        if (!contractible) {
+            continue;
+        }
+
+        int target = nearest.first;
+        preselect(term, target);
+        removeEdge(term, target);
+        std::vector<std::pair<int, int>> moved(graph[term].begin(), graph[term].end());
+        for (auto adj : moved) {
+            std::vector<std::pair<int, int>> path = expandEdge({term, adj.first});
+            if (graph[target].count(adj.first) == 0 || graph[target][adj.first] > adj.second) {
+                setEdge(target, adj.first, adj.second, std::move(path));
+            }
+        }
+        eraseNode(term, target);
+
+        if (isTerminal[target]) {
+            liveTerminals--;
+        } else {
+            isTerminal[target] = true;
+        }
+        changed = true;
+    }
+    return changed;
+}
+
+void Graph::rebuild() {
+    recomputeStatistics();
+
+    // number the remaining edges again and freeze the adjacency
+    edgeList.clear();
+    edgeWeightSum = 0;
+    for (int i = 0; i < nodeCount; i++) {
+        if (isErased[i]) {
+            continue;
+        }
+        for (auto adj : graph[i]) {
+            if (i < adj.first) {
+                edgeList.emplace_back(i, adj.first);
+                edgeWeightSum += adj.second;
+            }
+        }
+    }
+    edgeCount = (int)edgeList.size();
+    buildCsr();
+    std::sort(terminals.begin(), terminals.end());
+}
+
+void Graph::saveSnapshot(SnapshotWriter &output) const {
+    output.write(nodeCount);
+    output.write(edgeCount);
+    output.write(termCount);
+    output.write(edgeWeightSum);
+    output.write(preselectedWeight);
+    output.writeArray(isTerminal);
+    output.writeArray(isErased);
+    output.writeArray(terminals);
+    output.writeArray(edgeList);
+    output.writeArray(preselectedEdges);
+    output.writeArray(csrOffsets);
+    output.writeArray(csrTargets);
+    output.writeArray(csrWeights);
+    output.writeArray(csrEdgeIds);
+
+    // expansions of contracted edges, flattened with offsets into a single path pool
+    std::vector<std::pair<int, int>> keys, paths;
+    std::vector<unsigned> offsets = {0};
+    for (auto &entry : expansion) {
+        keys.push_back(entry.first);
+        paths.insert(paths.end(), entry.second.begin(), entry.second.end());
+        offsets.push_back((unsigned)paths.size());
+    }
+    output.writeArray(keys);
+    output.writeArray(offsets);
+    output.writeArray(paths);
+}
+
+void Graph::loadSnapshot(SnapshotReader &input) {
+    nodeCount = input.read<int>();
+    edgeCount = input.read<int>();
+    termCount = input.read<int>();
+    edgeWeightSum = input.read<unsigned>();
+    preselectedWeight = input.read<unsigned>();
+    input.readArray(isTerminal);
+    input.readArray(isErased);
+    input.readArray(terminals);
+    input.readArray(edgeList);
+    input.readArray(preselectedEdges);
+    input.readArray(csrOffsets);
+    input.readArray(csrTargets);
+    input.readArray(csrWeights);
+    input.readArray(csrEdgeIds);
+
+    std::vector<std::pair<int, int>> keys, paths;
+    std::vector<unsigned> offsets;
+    input.readArray(keys);
+    input.readArray(offsets);
+    input.readArray(paths);
+    expansion.clear();
+    for (unsigned i = 0; i < keys.size(); i++) {
+        expansion[keys[i]].assign(paths.begin() + offsets[i], paths.begin() + offsets[i + 1]);
+    }
+
+    graph.assign((unsigned)nodeCount, std::map<int, int>());
+    substitutes.assign((unsigned)nodeCount, -1);
+    leafCutReport = {0, 0, 0};
+}
@@ -2,15 +2,55 @@
 #define PACE2018_GRAPH_H
 
 #include <algorithm>
+#include <functional>
 #include <iostream>
+#include <limits>
 #include <map>
+#include <queue>
 #include <set>
 #include <vector>
 
+#include "utility/input_reader.h"
+#include "utility/snapshot.h"
+
 class Graph {
 public:
-    Graph() : nodeCount(0), edgeCount(0), termCount(0), edgeWeightSum(0) {}
+    /**
+     * Summary of the leaf cutting done while loading
+     */
+    struct LeafCutReport {
+        int removedNodes, removedEdges;
+        unsigned preselectedWeight;
+    };
+
+    Graph() : nodeCount(0), edgeCount(0), termCount(0), edgeWeightSum(0), leafCutReport{0, 0, 0} {}
     void load(std::istream &input);
+    void load(InputReader &input);
+
+    /**
+     * Stores the preprocessed graph in its frozen form. A graph read back from a snapshot has the
+     * compressed rows, terminals and edge expansions, but no adjacency maps for further reductions.
+     */
+    void saveSnapshot(SnapshotWriter &output) const;
+    void loadSnapshot(SnapshotReader &input);
+
+    /**
+     * Runs the Steiner tree reductions on the loaded graph: contraction of non-terminal degree two
+     * paths, deletion of edges longer than an alternative path, the non-terminal degree three test
+     * and the nearest vertex test for terminals. Contracted edges are remembered, so solutions
+     * over the reduced graph can be expanded back into original edges.
+     */
+    void reduce();
+
+    /**
+     * Original edges represented by an edge of the reduced graph
+     */
+    std::vector<std::pair<int, int>> expandEdge(const std::pair<int, int> &edge) const;
+
+    /**
+     * Node that took the place of a contracted node, -1 if the node was deleted for good
+     */
+    int substituteOf(int node) const;
 
     int idOfEdge(const std::pair<int, int>& edge) const;
     std::pair<int, int> edgeWithId(int id) const;
@@ -24,21 +64,73 @@ public:
     bool isNodeErased(int id) const;
     std::vector<std::pair<int, int>> getPreselectedEdges() const;
     int getPreselectedWeight() const;
+    const LeafCutReport &getLeafCutReport() const;
+
+    /**
+     * Frozen adjacency in compressed sparse row form, built once preprocessing is done.
+     * Arcs of a node occupy [arcBegin(node), arcEnd(node)) sorted by target, erased nodes have none.
+     */
+    unsigned arcBegin(int node) const {
+        return csrOffsets[node];
+    }
+
+    unsigned arcEnd(int node) const {
+        return csrOffsets[node + 1];
+    }
+
+    int arcTarget(unsigned arc) const {
+        return csrTargets[arc];
+    }
+
+    int arcWeight(unsigned arc) const {
+        return csrWeights[arc];
+    }
+
+    int arcEdgeId(unsigned arc) const {
+        return csrEdgeIds[arc];
+    }
+
+    /**
+     * Returns the arc from one node to another, or -1 if they are not adjacent
+     */
+    int findArc(int from, int to) const;
+    int getEdgeWeight(int from, int to) const;
 
 private:
-    int getFirstLeaf();
-    void cutLeaves();
+    LeafCutReport cutLeaves();
+    void preselect(int from, int to);
+
+    void setEdge(int from, int to, int weight, std::vector<std::pair<int, int>> path);
+    void removeEdge(int from, int to);
+    void eraseNode(int node, int substitute);
+    void boundedSearch(int source, unsigned bound, int avoidNode, const std::pair<int, int> &avoidEdge,
+                       const std::function<bool(int, unsigned)> &visit);
+
+    bool contractDegreeTwo();
+    bool deleteLongEdges();
+    bool deleteDegreeThree();
+    bool contractNearestVertices();
+    void rebuild();
     void recomputeStatistics();
-    void initEdgeIds();
+    int edgeIdInList(const std::pair<int, int> &edge) const;
+    void buildCsr();
 
     int nodeCount, edgeCount, termCount;
     unsigned edgeWeightSum, preselectedWeight;
 
     std::vector<std::map<int, int>> graph;
-    std::map<std::pair<int, int>, int> edgeIds;
     std::vector<std::pair<int, int>> edgeList, preselectedEdges;
     std::vector<bool> isTerminal, isErased;
     std::vector<int> terminals;
+    LeafCutReport leafCutReport;
+
+    // reduction state, contracted nodes point to the node they were merged into
+    std::vector<int> substitutes;
+    std::map<std::pair<int, int>, std::vector<std::pair<int, int>>> expansion;
+    std::vector<unsigned> searchDist;
+
+    std::vector<unsigned> csrOffsets;
+    std::vector<int> csrTargets, csrWeights, csrEdgeIds;
 };
 
 
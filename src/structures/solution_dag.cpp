@@ -0,0 +1,84 @@
+#include "solution_dag.h"
+
+SolutionDAG::SolutionDAG() : recordCount(0), blocks(new std::atomic<Record*>[BLOCK_COUNT]) {
+    for (unsigned i = 0; i < BLOCK_COUNT; i++) {
+        blocks[i] = nullptr;
+    }
+}
+
+SolutionDAG::~SolutionDAG() {
+    clear();
+}
+
+int SolutionDAG::addEdge(int parent, int edgeId) {
+    return append({parent, EMPTY, edgeId});
+}
+
+int SolutionDAG::join(int left, int right) {
+    // joining with an empty solution needs no new record
+    if (left == EMPTY) {
+        return right;
+    }
+    if (right == EMPTY) {
+        return left;
+    }
+    return append({left, right, EMPTY});
+}
+
+std::vector<int> SolutionDAG::collectEdges(int handle) const {
+    std::vector<int> edges, stack;
+    if (handle != EMPTY) {
+        stack.push_back(handle);
+    }
+
+    // every edge is introduced only once in the decomposition, so no record is reached twice
+    while (!stack.empty()) {
+        const Record &record = at(stack.back());
+        stack.pop_back();
+
+        if (record.edgeId != EMPTY) {
+            edges.push_back(record.edgeId);
+        }
+        if (record.left != EMPTY) {
+            stack.push_back(record.left);
+        }
+        if (record.right != EMPTY) {
+            stack.push_back(record.right);
+        }
+    }
+    return edges;
+}
+
+unsigned SolutionDAG::size() const {
+    return recordCount;
+}
+
+void SolutionDAG::clear() {
+    for (unsigned i = 0; i < BLOCK_COUNT; i++) {
+        delete[] blocks[i].exchange(nullptr);
+    }
+    recordCount = 0;
+}
+
+int SolutionDAG::append(const Record &record) {
+    unsigned idx = recordCount++;
+    std::atomic<Record*> &block = blocks[idx >> BLOCK_BITS];
+
+    // first writer into a block allocates it, concurrent losers throw their copy away
+    Record *storage = block.load();
+    if (storage == nullptr) {
+        auto fresh = new Record[1u << BLOCK_BITS];
+        if (block.compare_exchange_strong(storage, fresh)) {
+            storage = fresh;
+        } else {
+            delete[] fresh;
+        }
+    }
+
+    storage[idx & ((1u << BLOCK_BITS) - 1)] = record;
+    return (int)idx;
+}
+
+const SolutionDAG::Record &SolutionDAG::at(int handle) const {
+    return blocks[(unsigned)handle >> BLOCK_BITS][(unsigned)handle & ((1u << BLOCK_BITS) - 1)];
+}
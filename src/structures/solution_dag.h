@@ -0,0 +1,51 @@
+#ifndef PACE2018_SOLUTION_DAG_H
+#define PACE2018_SOLUTION_DAG_H
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+/**
+ * Append-only arena of partial solutions, used for backtracking of the DP solvers
+ *
+ * Every record points to at most two parent records and may add a single edge, so a DP state
+ * only needs to keep the index of its record. The edges of a solution are gathered by walking
+ * the records reachable from its handle.
+ *
+ * Records live in fixed size blocks that are never moved, so several threads may append at once.
+ */
+class SolutionDAG {
+public:
+    static const int EMPTY = -1;
+
+    SolutionDAG();
+    ~SolutionDAG();
+
+    SolutionDAG(const SolutionDAG&) = delete;
+    SolutionDAG& operator=(const SolutionDAG&) = delete;
+
+    int addEdge(int parent, int edgeId);
+    int join(int left, int right);
+
+    std::vector<int> collectEdges(int handle) const;
+
+    unsigned size() const;
+    void clear();
+
+private:
+    struct Record {
+        int left, right, edgeId;
+    };
+
+    static const unsigned BLOCK_BITS = 16;
+    static const unsigned BLOCK_COUNT = 1u << (31 - BLOCK_BITS);
+
+    int append(const Record &record);
+    const Record &at(int handle) const;
+
+    std::atomic<unsigned> recordCount;
+    std::unique_ptr<std::atomic<Record*>[]> blocks;
+};
+
+
+#endif //PACE2018_SOLUTION_DAG_H
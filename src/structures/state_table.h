@@ -0,0 +1,163 @@
+#ifndef PACE2018_STATE_TABLE_H
+#define PACE2018_STATE_TABLE_H
+
+#include <cstdint>
+#include <vector>
+
+#include "utility/partition_traits.h"
+
+/**
+ * Flat open-addressing table of DP states, keyed by packed partitions
+ *
+ * Each slot keeps the partition, its cost and a solver specific backtrack handle side by side,
+ * collisions are resolved by linear probing in a power of two sized array.
+ */
+template <typename Handle, typename Partition = uint64_t>
+class StateTable {
+public:
+    struct Entry {
+        Partition partition;
+        unsigned cost;
+        Handle handle;
+    };
+
+    class Iterator {
+    public:
+        Iterator(const Entry *ptr, const Entry *end) : ptr(ptr), end(end) {
+            skipEmpty();
+        }
+
+        const Entry &operator*() const {
+            return *ptr;
+        }
+
+        const Entry *operator->() const {
+            return ptr;
+        }
+
+        Iterator &operator++() {
+            ++ptr;
+            skipEmpty();
+            return *this;
+        }
+
+        bool operator==(const Iterator &other) const {
+            return ptr == other.ptr;
+        }
+
+        bool operator!=(const Iterator &other) const {
+            return ptr != other.ptr;
+        }
+
+    private:
+        void skipEmpty() {
+            while (ptr != end && ptr->partition == Traits::empty()) {
+                ++ptr;
+            }
+        }
+
+        const Entry *ptr, *end;
+    };
+
+    StateTable() : used(0), shift(64) {}
+
+    /**
+     * Inserts the state, or lowers the cost of an already present one, using a single probe
+     * sequence. Returns the touched entry so the caller can fill in the handle, or nullptr
+     * if the stored cost was already at least as good.
+     */
+    Entry *improve(const Partition &partition, unsigned cost) {
+        if (((used + 1) << 1u) > slots.size()) {
+            grow();
+        }
+        Entry &entry = slots[probe(partition)];
+        if (entry.partition == Traits::empty()) {
+            entry.partition = partition;
+            entry.cost = cost;
+            used++;
+            return &entry;
+        }
+        if (cost < entry.cost) {
+            entry.cost = cost;
+            return &entry;
+        }
+        return nullptr;
+    }
+
+    const Entry *find(const Partition &partition) const {
+        if (used == 0) {
+            return nullptr;
+        }
+        const Entry &entry = slots[probe(partition)];
+        return entry.partition == Traits::empty() ? nullptr : &entry;
+    }
+
+    bool contains(const Partition &partition) const {
+        return find(partition) != nullptr;
+    }
+
+    unsigned costOf(const Partition &partition) const {
+        return find(partition)->cost;
+    }
+
+    const Handle &handleOf(const Partition &partition) const {
+        return find(partition)->handle;
+    }
+
+    unsigned size() const {
+        return used;
+    }
+
+    bool empty() const {
+        return used == 0;
+    }
+
+    void clear() {
+        std::vector<Entry>().swap(slots);
+        used = 0;
+        shift = 64;
+    }
+
+    Iterator begin() const {
+        return Iterator(slots.data(), slots.data() + slots.size());
+    }
+
+    Iterator end() const {
+        return Iterator(slots.data() + slots.size(), slots.data() + slots.size());
+    }
+
+private:
+    typedef PartitionTraits<Partition> Traits;
+
+    unsigned probe(const Partition &partition) const {
+        // fibonacci hashing, top bits of the product select the home slot
+        auto mask = (unsigned)(slots.size() - 1);
+        auto idx = (unsigned)((Traits::hash(partition) * 0x9E3779B97F4A7C15ull) >> shift);
+        while (slots[idx].partition != partition && slots[idx].partition != Traits::empty()) {
+            idx = (idx + 1) & mask;
+        }
+        return idx;
+    }
+
+    void grow() {
+        std::vector<Entry> old;
+        old.swap(slots);
+        slots.resize(old.empty() ? 8 : old.size() << 1u);
+        for (auto &slot : slots) {
+            slot.partition = Traits::empty();
+        }
+        shift = 64 - (unsigned)__builtin_ctzll(slots.size());
+
+        for (auto &entry : old) {
+            if (entry.partition != Traits::empty()) {
+                slots[probe(entry.partition)] = std::move(entry);
+            }
+        }
+    }
+
+    std::vector<Entry> slots;
+    unsigned used, shift;
+};
+
+
+#endif //PACE2018_STATE_TABLE_H
@@ -1,165 +1,645 @@
 #include "tree_decomposition.h"
 
 void TreeDecomposition::load(std::istream &input) {
-    std::string skip;
-    input >> skip >> skip >> skip; // skip "SECTION Tree Decomposition
+    InputReader reader(input, 1);
+    load(reader);
+}
 
-    // read header
-    input >> skip;
-    if (skip == "c") {
-        input.ignore(std::numeric_limits<std::streamsize>::max(), input.widen('\n'));
-        input >> skip;
-    }
-    input >> skip >> nodeCount >> width >> origNodes;
-    input.ignore(std::numeric_limits<std::streamsize>::max(), input.widen('\n'));
-    nodes.clear();
-    nodes.resize(nodeCount);
+void TreeDecomposition::load(InputReader &input) {
+    input.readWord(); input.readWord(); input.readWord(); // skip "SECTION Tree Decomposition
+
+    // read header, comment lines are skipped by the reader
+    input.readWord(); input.readWord(); // skip "s td"
+    nodeCount = (unsigned)input.readInt();
+    width = (unsigned)input.readInt();
+    origNodes = (unsigned)input.readInt();
+    std::vector<BuildNode> nodes(nodeCount);
 
     // read bags
     for (unsigned i = 0; i < nodeCount; ++i) {
-        std::string line;
-        std::getline(input, line);
-        std::istringstream linestream(line, std::ios_base::in);
-        linestream >> skip;
-        int bagId;
-        linestream >> bagId;
-        bagId--;
-        int content;
-        while (linestream >> content) {
-            nodes[bagId].bag.push_back(content-1);
+        input.readWord();
+        int bagId = (int)input.readInt() - 1;
+        long long content;
+        while (input.readIntOnLine(content)) {
+            nodes[bagId].bag.push_back((int)content - 1);
         }
     }
 
     // read edgeCount
-    for (unsigned i = 0; i < nodeCount - 1; ++i) {
-        int vertA, vertB = -1;
-        input >> vertA >> vertB;
-        vertA--; vertB--;
+    for (unsigned i = 0; i + 1 < nodeCount; ++i) {
+        int vertA = (int)input.readInt() - 1, vertB = (int)input.readInt() - 1;
         nodes[vertA].adjacent.push_back(vertB);
         nodes[vertB].adjacent.push_back(vertA);
     }
 
     // END
-    input >> skip;
+    input.readWord();
+    freeze(nodes);
 }
 
-const std::vector<int> &TreeDecomposition::getAdjacentTo(int node) const {
-    return nodes[node].adjacent;
+void TreeDecomposition::computeHeuristic(const Graph &graph, double timeBudget) {
+    EliminationOrdering ordering(graph);
+    ordering.compute(timeBudget);
+
+    std::vector<std::vector<int>> bags;
+    std::vector<std::pair<int, int>> treeEdges;
+    ordering.getDecomposition(bags, treeEdges);
+
+    std::vector<BuildNode> nodes(bags.size());
+    for (unsigned i = 0; i < bags.size(); i++) {
+        nodes[i].bag = std::move(bags[i]);
+    }
+    for (auto &edge : treeEdges) {
+        nodes[edge.first].adjacent.push_back(edge.second);
+        nodes[edge.second].adjacent.push_back(edge.first);
+    }
+
+    width = ordering.getWidth();
+    origNodes = (unsigned)graph.getNodeCount();
+    freeze(nodes);
 }
 
-const std::vector<int> &TreeDecomposition::getBagOf(int node) const {
-    return nodes[node].bag;
+void TreeDecomposition::improve(const Graph &graph, double timeBudget) {
+    clock_t deadline = clock() + (clock_t)(timeBudget * CLOCKS_PER_SEC);
+    std::vector<BuildNode> nodes = thaw();
+    removeErasedNodes(graph, nodes);
+    for (auto &node : nodes) {
+        std::sort(node.bag.begin(), node.bag.end());
+    }
+    std::vector<bool> removed(nodes.size(), false);
+    removeRedundantBags(nodes, removed);
+
+    // largest bags first, their tables dominate the DP, bags well below the width are not worth the time
+    bool changed = true;
+    while (changed && clock() <= deadline) {
+        size_t largest = 0;
+        for (unsigned node = 0; node < nodes.size(); node++) {
+            largest = removed[node] ? largest : std::max(largest, nodes[node].bag.size());
+        }
+        std::vector<int> candidates;
+        for (unsigned node = 0; node < nodes.size(); node++) {
+            if (!removed[node] && nodes[node].bag.size() > 2 &&
+                    nodes[node].bag.size() + RETRIANGULATE_SLACK >= largest) {
+                candidates.push_back(node);
+            }
+        }
+        std::stable_sort(candidates.begin(), candidates.end(), [&](int a, int b) {
+            return nodes[a].bag.size() > nodes[b].bag.size();
+        });
+
+        changed = false;
+        for (auto node : candidates) {
+            if (clock() > deadline) {
+                break;
+            }
+            changed |= retriangulate(node, graph, nodes);
+        }
+        removed.resize(nodes.size(), false);
+        removeRedundantBags(nodes, removed);
+    }
+
+    // drop the merged bags and renumber the rest
+    std::vector<int> newId(nodes.size(), -1);
+    std::vector<BuildNode> compact;
+    for (unsigned node = 0; node < nodes.size(); node++) {
+        if (!removed[node]) {
+            newId[node] = (int)compact.size();
+            compact.push_back(std::move(nodes[node]));
+        }
+    }
+    width = 0;
+    for (auto &node : compact) {
+        for (auto &adj : node.adjacent) {
+            adj = newId[adj];
+        }
+        width = std::max(width, (unsigned)node.bag.size());
+    }
+    freeze(compact);
 }
 
-void TreeDecomposition::convertToNice(const Graph &sourceGraph) {
-    removeErasedNodes(sourceGraph);
+void TreeDecomposition::removeRedundantBags(std::vector<BuildNode> &nodes, std::vector<bool> &removed) const {
+    std::vector<int> work;
+    for (unsigned node = 0; node < nodes.size(); node++) {
+        if (!removed[node]) {
+            work.push_back(node);
+        }
+    }
 
-    std::vector<Node> niceNodes;
-    enabledEdges.clear();
+    while (!work.empty()) {
+        int node = work.back();
+        work.pop_back();
+        if (removed[node]) {
+            continue;
+        }
+
+        std::vector<int> adjacent = nodes[node].adjacent;
+        for (auto target : adjacent) {
+            if (!std::includes(nodes[target].bag.begin(), nodes[target].bag.end(),
+                               nodes[node].bag.begin(), nodes[node].bag.end())) {
+                continue;
+            }
 
-    // find leaf to be the new root
-    int uglyRoot = 0;
-    for (auto node : nodes) {
-        if (node.adjacent.size() == 1) {
+            // the bag adds nothing, its other neighbours move over to the one containing it
+            auto &targetAdjacent = nodes[target].adjacent;
+            targetAdjacent.erase(std::find(targetAdjacent.begin(), targetAdjacent.end(), node));
+            for (auto other : adjacent) {
+                if (other == target) {
+                    continue;
+                }
+                std::replace(nodes[other].adjacent.begin(), nodes[other].adjacent.end(), node, target);
+                targetAdjacent.push_back(other);
+                work.push_back(other);
+            }
+            nodes[node].adjacent.clear();
+            removed[node] = true;
+            work.push_back(target);
             break;
         }
-        uglyRoot++;
     }
-    int currId = 0;
-    beautifyDFS(currId, uglyRoot, -1, niceNodes, sourceGraph);
+}
 
-    nodeCount = (unsigned)currId;
-    nodes = niceNodes;
-    for (unsigned i = 0; i < nodeCount; ++i) {
-        std::sort(nodes[i].bag.begin(), nodes[i].bag.end());
+bool TreeDecomposition::retriangulate(int node, const Graph &graph, std::vector<BuildNode> &nodes) const {
+    // torso over the positions in the sorted bag
+    const std::vector<int> bag = nodes[node].bag;
+    std::vector<std::vector<int>> torso(bag.size());
+    auto positionOf = [&](int item) {
+        return (int)(std::lower_bound(bag.begin(), bag.end(), item) - bag.begin());
+    };
+    for (unsigned i = 0; i < bag.size(); i++) {
+        for (unsigned j = i + 1; j < bag.size(); j++) {
+            if (graph.findArc(bag[i], bag[j]) != -1) {
+                torso[i].push_back(j);
+                torso[j].push_back(i);
+            }
+        }
+    }
+    std::vector<std::vector<int>> separators;
+    for (auto adj : nodes[node].adjacent) {
+        separators.emplace_back();
+        std::set_intersection(bag.begin(), bag.end(), nodes[adj].bag.begin(), nodes[adj].bag.end(),
+                              std::back_inserter(separators.back()));
+        for (unsigned i = 0; i < separators.back().size(); i++) {
+            for (unsigned j = i + 1; j < separators.back().size(); j++) {
+                int first = positionOf(separators.back()[i]), second = positionOf(separators.back()[j]);
+                torso[first].push_back(second);
+                torso[second].push_back(first);
+            }
+        }
+    }
+
+    EliminationOrdering ordering(std::move(torso));
+    ordering.compute(TORSO_BUDGET);
+    if (ordering.getWidth() >= bag.size()) {
+        return false;
+    }
+
+    std::vector<std::vector<int>> torsoBags;
+    std::vector<std::pair<int, int>> torsoEdges;
+    ordering.getDecomposition(torsoBags, torsoEdges);
+
+    // the first torso bag takes over the slot of the replaced one
+    std::vector<int> ids(torsoBags.size(), node);
+    for (unsigned i = 1; i < torsoBags.size(); i++) {
+        ids[i] = (int)nodes.size();
+        nodes.emplace_back();
+    }
+    std::vector<int> oldAdjacent = nodes[node].adjacent;
+    nodes[node].adjacent.clear();
+    for (unsigned i = 0; i < torsoBags.size(); i++) {
+        std::vector<int> &newBag = nodes[ids[i]].bag;
+        newBag.clear();
+        for (auto position : torsoBags[i]) {
+            newBag.push_back(bag[position]);
+        }
+        std::sort(newBag.begin(), newBag.end());
+    }
+    for (auto &edge : torsoEdges) {
+        nodes[ids[edge.first]].adjacent.push_back(ids[edge.second]);
+        nodes[ids[edge.second]].adjacent.push_back(ids[edge.first]);
+    }
+
+    // every separator is a clique of the torso, so some of its bags contains it whole
+    for (unsigned i = 0; i < oldAdjacent.size(); i++) {
+        int neighbour = oldAdjacent[i], attachTo = node;
+        for (auto id : ids) {
+            if (std::includes(nodes[id].bag.begin(), nodes[id].bag.end(),
+                              separators[i].begin(), separators[i].end())) {
+                attachTo = id;
+                break;
+            }
+        }
+        std::replace(nodes[neighbour].adjacent.begin(), nodes[neighbour].adjacent.end(), node, attachTo);
+        nodes[attachTo].adjacent.push_back(neighbour);
+    }
+    return true;
+}
+
+void TreeDecomposition::saveSnapshot(SnapshotWriter &output) const {
+    output.write(nodeCount);
+    output.write(width);
+    output.write(origNodes);
+    output.writeArray(types);
+    output.writeArray(associatedNodes);
+    output.writeArray(associatedEdges);
+    output.writeArray(bagOffsets);
+    output.writeArray(bagPool);
+    output.writeArray(adjacentOffsets);
+    output.writeArray(adjacentPool);
+    output.writeArray(indices);
+}
+
+void TreeDecomposition::loadSnapshot(SnapshotReader &input) {
+    nodeCount = input.read<unsigned>();
+    width = input.read<unsigned>();
+    origNodes = input.read<unsigned>();
+    input.readArray(types);
+    input.readArray(associatedNodes);
+    input.readArray(associatedEdges);
+    input.readArray(bagOffsets);
+    input.readArray(bagPool);
+    input.readArray(adjacentOffsets);
+    input.readArray(adjacentPool);
+    input.readArray(indices);
+}
+
+void TreeDecomposition::freeze(const std::vector<BuildNode> &built) {
+    nodeCount = (unsigned)built.size();
+    size_t bagTotal = 0, adjacentTotal = 0;
+    for (auto &node : built) {
+        bagTotal += node.bag.size();
+        adjacentTotal += node.adjacent.size();
+    }
+
+    bagPool.clear();
+    bagPool.reserve(bagTotal);
+    adjacentPool.clear();
+    adjacentPool.reserve(adjacentTotal);
+    bagOffsets.assign(1, 0);
+    adjacentOffsets.assign(1, 0);
+    types.clear();
+    associatedNodes.clear();
+    associatedEdges.clear();
+    for (auto &node : built) {
+        bagPool.insert(bagPool.end(), node.bag.begin(), node.bag.end());
+        bagOffsets.push_back((unsigned)bagPool.size());
+        adjacentPool.insert(adjacentPool.end(), node.adjacent.begin(), node.adjacent.end());
+        adjacentOffsets.push_back((unsigned)adjacentPool.size());
+        types.push_back((uint8_t)node.type);
+        associatedNodes.push_back(node.associatedNode);
+        associatedEdges.push_back(node.associatedEdge);
     }
+    indices.assign(nodeCount, NodeIndex());
 }
 
-void TreeDecomposition::beautifyDFS(int &currId,
-                                    int uglyNode,
-                                    int uglyParent,
-                                    std::vector<Node> &niceNodes,
-                                    const Graph &graph) {
-    // TODO: edge case, single node in whole decompo
-    if (getAdjacentTo(uglyNode).empty()) {
-        std::cerr << "Node without neighbors" << std::endl;
+std::vector<TreeDecomposition::BuildNode> TreeDecomposition::thaw() const {
+    std::vector<BuildNode> nodes(nodeCount);
+    for (unsigned i = 0; i < nodeCount; i++) {
+        nodes[i].bag = getBagOf(i).toVector();
+        nodes[i].adjacent = getAdjacentTo(i).toVector();
+        nodes[i].type = (NodeType)types[i];
+        nodes[i].associatedNode = associatedNodes[i];
+        nodes[i].associatedEdge = associatedEdges[i];
+    }
+    return nodes;
+}
+
+ArrayView<int> TreeDecomposition::getAdjacentTo(int node) const {
+    return ArrayView<int>(adjacentPool.data() + adjacentOffsets[node], adjacentOffsets[node + 1] - adjacentOffsets[node]);
+}
+
+ArrayView<int> TreeDecomposition::getBagOf(int node) const {
+    return ArrayView<int>(bagPool.data() + bagOffsets[node], bagOffsets[node + 1] - bagOffsets[node]);
+}
+
+void TreeDecomposition::convertToNice(const Graph &sourceGraph) {
+    std::vector<BuildNode> uglyNodes = thaw();
+    removeErasedNodes(sourceGraph, uglyNodes);
+
+    // an empty decomposition is one empty bag, a lone bag still needs a neighbour to be converted
+    if (uglyNodes.empty()) {
+        uglyNodes.emplace_back();
+    }
+    if (uglyNodes.size() == 1) {
+        uglyNodes.emplace_back();
+        uglyNodes[0].adjacent.push_back(1);
+        uglyNodes[1].adjacent.push_back(0);
+    }
+    freeze(uglyNodes);
+
+    std::vector<BuildNode> niceNodes;
+    enabledEdges.clear();
+
+    int uglyRoot = chooseRoot(sourceGraph);
+    if (uglyRoot == -1) {
+        std::cerr << "Error, decomposition has no leaf to root at!" << std::endl;
         exit(1);
     }
+    niceNodes.reserve(countNiceNodes(uglyRoot, sourceGraph));
+    beautify(uglyRoot, estimateSubtrees(uglyRoot, sourceGraph), niceNodes, sourceGraph);
 
-    bool isRoot = (uglyParent == -1);
+    for (auto &node : niceNodes) {
+        std::sort(node.bag.begin(), node.bag.end());
+    }
+    freeze(niceNodes);
+    indexNodes(sourceGraph);
+}
 
-    // leaf that is not root
-    if (getAdjacentTo(uglyNode).size() == 1 && !isRoot) {
-        std::vector<int> reservoir = getBagOf(uglyNode);
+double TreeDecomposition::estimateStates(ArrayView<int> bag, const Graph &graph,
+                                         double terminalWeight, double otherWeight) {
+    // every used node either starts a new block or joins an existing one, roughly doubling the partitions
+    double states = 1;
+    for (auto item : bag) {
+        states *= graph.isTerm(item) ? terminalWeight : otherWeight;
+    }
+    return states;
+}
 
-        while (!reservoir.empty()) {
-            niceNodes.emplace_back();
-            niceNodes[currId].type = INTRO;
-            niceNodes[currId].associatedNode = reservoir.back();
-            niceNodes[currId].bag = reservoir;
-            niceNodes[currId].adjacent = {currId + 1};
-            reservoir.pop_back();
-            currId++;
+double TreeDecomposition::estimateDPStates(const Graph &graph) const {
+    double states = 0;
+    for (unsigned node = 0; node < nodeCount; node++) {
+        if (types[node] == JOIN) {
+            // pairs of partitions of the same subset, four per used node
+            states += estimateStates(getBagOf(node), graph, 4, 5);
+        } else {
+            states += estimateStates(getBagOf(node), graph);
         }
+    }
+    return states;
+}
 
-        niceNodes.emplace_back();
-        niceNodes[currId].type = LEAF;
-        niceNodes[currId].adjacent = {};
-        currId++;
-        return;
+int TreeDecomposition::chooseRoot(const Graph &graph) const {
+    // every leaf adds the same chain of bags whether it is the root or not, so the root only decides
+    // how far markDeletableNodes has to walk: a terminal in the root bag is forgotten right at the top
+    int bestRoot = -1;
+    bool bestHasTerminal = false;
+    double bestStates = 0;
+    for (unsigned node = 0; node < nodeCount; node++) {
+        if (getAdjacentTo(node).size() != 1) {
+            continue;
+        }
+        ArrayView<int> bag = getBagOf(node);
+        bool hasTerminal = std::any_of(bag.begin(), bag.end(), [&](int item) {
+            return graph.isTerm(item);
+        });
+        double states = estimateStates(bag, graph);
+        if (bestRoot == -1 || (hasTerminal && !bestHasTerminal) ||
+                (hasTerminal == bestHasTerminal && states < bestStates)) {
+            bestRoot = node;
+            bestHasTerminal = hasTerminal;
+            bestStates = states;
+        }
     }
+    return bestRoot;
+}
 
-    std::vector<int> children = getAdjacentTo(uglyNode);
-    if (!isRoot) {
-        children.erase(std::remove(children.begin(), children.end(), uglyParent), children.end());
+std::vector<double> TreeDecomposition::estimateSubtrees(int uglyRoot, const Graph &graph) const {
+    // breadth first order from the root, accumulated backwards so children are summed before parents
+    std::vector<int> order, parent(nodeCount, -1);
+    order.reserve(nodeCount);
+    order.push_back(uglyRoot);
+    for (size_t i = 0; i < order.size(); i++) {
+        int node = order[i];
+        for (auto adj : getAdjacentTo(node)) {
+            if (adj != parent[node]) {
+                parent[adj] = node;
+                order.push_back(adj);
+            }
+        }
     }
 
-    // create chain to the root bag
-    if (isRoot && !getBagOf(uglyNode).empty()) {
-        // root leaf
-        std::vector<int> targetBag = getBagOf(uglyNode), currentBag;
-        currentBag.push_back(targetBag.back());
+    std::vector<double> states(nodeCount, 0);
+    for (size_t i = order.size(); i-- > 0;) {
+        int node = order[i];
+        // each child gets a chain of bags at most this large, all but the last one also a join
+        size_t children = getAdjacentTo(node).size() - (node == uglyRoot ? 0 : 1);
+        states[node] += estimateStates(getBagOf(node), graph) * (double)std::max<size_t>(2 * children, 2);
+        if (parent[node] != -1) {
+            states[parent[node]] += states[node];
+        }
+    }
+    return states;
+}
 
-        niceNodes.emplace_back();
-        niceNodes[currId].type = FORGET;
-        niceNodes[currId].adjacent = {currId + 1};
-        niceNodes[currId].associatedNode = targetBag.back();
-        currId++;
+void TreeDecomposition::indexNodes(const Graph &graph) {
+    auto positionIn = [](ArrayView<int> bag, int item) {
+        return (unsigned)(std::lower_bound(bag.begin(), bag.end(), item) - bag.begin());
+    };
+
+    for (unsigned nodeId = 0; nodeId < nodeCount; nodeId++) {
+        NodeIndex &index = indices[nodeId];
+        ArrayView<int> bag = getBagOf(nodeId);
+
+        // the parent is the only neighbour with a lower id
+        unsigned childPtr = 0;
+        for (auto adj : getAdjacentTo(nodeId)) {
+            if (adj > (int)nodeId && childPtr < 2) {
+                index.children[childPtr++] = adj;
+            }
+        }
+
+        for (unsigned i = 0; i < bag.size() && i < 32; i++) {
+            if (graph.isTerm(bag[i])) {
+                index.termMask |= 1u << i;
+            }
+        }
+
+        // bags are sorted by now, so the positions come from a binary search
+        switch ((NodeType)types[nodeId]) {
+            case INTRO:
+                index.position = positionIn(bag, associatedNodes[nodeId]);
+                break;
+            case FORGET:
+                index.position = positionIn(getBagOf(index.children[0]), associatedNodes[nodeId]);
+                break;
+            case INTRO_EDGE: {
+                std::pair<int, int> edge = associatedEdges[nodeId];
+                index.edgePositions[0] = positionIn(bag, edge.first);
+                index.edgePositions[1] = positionIn(bag, edge.second);
+                int arc = graph.findArc(edge.first, edge.second);
+                index.edgeWeight = (unsigned)graph.arcWeight(arc);
+                index.edgeId = graph.arcEdgeId(arc);
+                break;
+            }
+            default:
+                break;
+        }
+    }
+}
+
+size_t TreeDecomposition::countNiceNodes(int uglyRoot, const Graph &graph) const {
+    // every intro edge node belongs to a graph edge, the rest follows from the bags alone
+    size_t count = getBagOf(uglyRoot).size() + (size_t)graph.getEdgeCount();
+    std::vector<bool> inBag((size_t)graph.getNodeCount(), false);
+    for (unsigned node = 0; node < nodeCount; node++) {
+        ArrayView<int> bag = getBagOf(node), adjacent = getAdjacentTo(node);
+        bool isRoot = ((int)node == uglyRoot);
+        if (adjacent.size() == 1 && !isRoot) {
+            // intro chain down to the leaf
+            count += bag.size() + 1;
+        } else {
+            // joins between the children
+            count += adjacent.size() - (isRoot ? 1 : 2);
+        }
+
+        // intro and forget chains, each tree edge gets the part of the bag missing on the other side
+        for (auto item : bag) {
+            inBag[item] = true;
+        }
+        for (auto adj : adjacent) {
+            size_t shared = 0;
+            for (auto item : getBagOf(adj)) {
+                shared += inBag[item] ? 1 : 0;
+            }
+            count += bag.size() - shared;
+        }
+        for (auto item : bag) {
+            inBag[item] = false;
+        }
+    }
+    return count;
+}
+
+void TreeDecomposition::beautify(int uglyRoot,
+                                 const std::vector<double> &subtreeStates,
+                                 std::vector<BuildNode> &niceNodes,
+                                 const Graph &graph) {
+    // ugly nodes whose children are being converted, deep decompositions would overflow the call stack
+    struct Frame {
+        int uglyNode;
+        std::vector<int> children;
+        unsigned nextChild;
+        int currParent;
+    };
+    std::vector<Frame> stack;
+    int currId = 0;
+
+    // cheap nodes, terminals under the cost model, are kept in the bags for the longer part of a chain
+    auto terminalsFirst = [&](std::vector<int> &nodes) {
+        std::stable_partition(nodes.begin(), nodes.end(), [&](int item) {
+            return graph.isTerm(item);
+        });
+    };
+    auto terminalsLast = [&](std::vector<int> &nodes) {
+        std::stable_partition(nodes.begin(), nodes.end(), [&](int item) {
+            return !graph.isTerm(item);
+        });
+    };
+
+    // attach the next branch once the subtree of a child is complete
+    auto finishChild = [&]() {
+        if (stack.empty()) {
+            return;
+        }
+        Frame &frame = stack.back();
+        if (frame.nextChild != frame.children.size()) {
+            niceNodes[frame.currParent].adjacent.push_back(currId);
+        }
+    };
+
+    auto enter = [&](int uglyNode, int uglyParent) {
+        if (getAdjacentTo(uglyNode).empty()) {
+            std::cerr << "Node without neighbors" << std::endl;
+            exit(1);
+        }
+
+        bool isRoot = (uglyParent == -1);
+
+        // leaf that is not root
+        if (getAdjacentTo(uglyNode).size() == 1 && !isRoot) {
+            // introduced from the back, so the nonterminals join the bag last
+            std::vector<int> reservoir = getBagOf(uglyNode).toVector();
+            terminalsFirst(reservoir);
+
+            while (!reservoir.empty()) {
+                niceNodes.emplace_back();
+                niceNodes[currId].type = INTRO;
+                niceNodes[currId].associatedNode = reservoir.back();
+                niceNodes[currId].bag = reservoir;
+                niceNodes[currId].adjacent = {currId + 1};
+                reservoir.pop_back();
+                currId++;
+            }
+
+            niceNodes.emplace_back();
+            niceNodes[currId].type = LEAF;
+            niceNodes[currId].adjacent = {};
+            currId++;
+            finishChild();
+            return;
+        }
+
+        std::vector<int> children = getAdjacentTo(uglyNode).toVector();
+        if (!isRoot) {
+            children.erase(std::remove(children.begin(), children.end(), uglyParent), children.end());
+        }
+        // the most expensive branch gets the highest ids, solveBottomUp starts with those
+        std::stable_sort(children.begin(), children.end(), [&](int a, int b) {
+            return subtreeStates[a] < subtreeStates[b];
+        });
+
+        // create chain to the root bag
+        if (isRoot && !getBagOf(uglyNode).empty()) {
+            // root leaf
+            // forgotten from the back, a terminal on top lets markDeletableNodes stop right away
+            std::vector<int> targetBag = getBagOf(uglyNode).toVector(), currentBag;
+            terminalsLast(targetBag);
+            currentBag.push_back(targetBag.back());
 
-        addIntroEdgesOfNode(currId, targetBag.back(), currentBag, graph, niceNodes);
-        while (targetBag.size() != 1) {
-            targetBag.pop_back();
             niceNodes.emplace_back();
             niceNodes[currId].type = FORGET;
-            niceNodes[currId].bag = currentBag;
-            niceNodes[currId].associatedNode = targetBag.back();
             niceNodes[currId].adjacent = {currId + 1};
+            niceNodes[currId].associatedNode = targetBag.back();
             currId++;
-            currentBag.push_back(targetBag.back());
+
             addIntroEdgesOfNode(currId, targetBag.back(), currentBag, graph, niceNodes);
+            while (targetBag.size() != 1) {
+                targetBag.pop_back();
+                niceNodes.emplace_back();
+                niceNodes[currId].type = FORGET;
+                niceNodes[currId].bag = currentBag;
+                niceNodes[currId].associatedNode = targetBag.back();
+                niceNodes[currId].adjacent = {currId + 1};
+                currId++;
+                currentBag.push_back(targetBag.back());
+                addIntroEdgesOfNode(currId, targetBag.back(), currentBag, graph, niceNodes);
+            }
         }
-    }
 
-    int currParent = currId - 1;
-    for (int i = 0; i < (int) children.size(); i++) {
+        stack.push_back({uglyNode, std::move(children), 0, currId - 1});
+    };
+
+    enter(uglyRoot, -1);
+    while (!stack.empty()) {
+        Frame &frame = stack.back();
+        if (frame.nextChild == frame.children.size()) {
+            stack.pop_back();
+            finishChild();
+            continue;
+        }
+
+        int uglyNode = frame.uglyNode;
+        unsigned i = frame.nextChild++;
+        bool isLast = (frame.nextChild == frame.children.size());
+
         // create new JOIN root
-        std::vector<int> targetBag = getBagOf(children[i]), currentBag = getBagOf(uglyNode);
-        if (i != (int) children.size() - 1) {
+        std::vector<int> targetBag = getBagOf(frame.children[i]).toVector(), currentBag = getBagOf(uglyNode).toVector();
+        if (!isLast) {
             niceNodes.emplace_back();
             niceNodes[currId].type = JOIN;
-            niceNodes[currId].bag = getBagOf(uglyNode);
-            currParent = currId;
+            niceNodes[currId].bag = currentBag;
+            frame.currParent = currId;
             currId++;
-            isRoot = false;
         }
 
         // attach i-th child branch
-        if (i != (int) children.size() - 1) {
-            niceNodes[currParent].adjacent.push_back(currId);
+        if (!isLast) {
+            niceNodes[frame.currParent].adjacent.push_back(currId);
         }
         // create a nice path fron JOIN to i-th child
         std::vector<int> intersect, exCurr, exTarget, targetReservoir;
         divide(currentBag, targetBag, intersect, exCurr, exTarget);
+        terminalsFirst(exCurr);
+        terminalsLast(exTarget);
         while (!exCurr.empty()) {
             niceNodes.emplace_back();
             niceNodes[currId].type = INTRO;
@@ -177,10 +657,6 @@ void TreeDecomposition::beautifyDFS(int &currId,
             niceNodes[currId].type = FORGET;
             niceNodes[currId].bag = intersect;
             niceNodes[currId].associatedNode = exTarget.back();
-            // empty root case
-            if (isRoot) {
-                isRoot = false;
-            }
             niceNodes[currId].adjacent = {currId + 1};
             currId++;
             intersect.push_back(exTarget.back());
@@ -188,27 +664,21 @@ void TreeDecomposition::beautifyDFS(int &currId,
             exTarget.pop_back();
         }
 
-        // attach child subtree
-        beautifyDFS(currId, children[i], uglyNode, niceNodes, graph);
-
-        // attach next branch
-        if (i != (int) children.size() - 1) {
-            niceNodes[currParent].adjacent.push_back(currId);
-        }
+        // attach child subtree, the frame reference is not used past this point
+        enter(frame.children[i], uglyNode);
     }
 }
 
 void TreeDecomposition::printTree(std::ostream &output) {
-    int nodeId = 0;
-    for (auto &node : nodes) {
-        output << "Node ID: " << nodeId++;
+    for (unsigned nodeId = 0; nodeId < nodeCount; nodeId++) {
+        Node node = getNodeAt(nodeId);
+        output << "Node ID: " << nodeId;
         output << "  Adjacent:";
         for (auto adj : node.adjacent) {
             output << " " << adj;
         }
         output << "  Bag:";
-        std::vector<int> bag = node.bag;
-        for (auto item : bag) {
+        for (auto item : node.bag) {
             output << " " << item;
         }
         output << "  Type: ";
@@ -246,9 +716,9 @@ void TreeDecomposition::addIntroEdgesOfNode(int &currId,
                                             int node,
                                             const std::vector<int> &bag,
                                             const Graph &graph,
-                                            std::vector<Node> &niceNodes) {
-    for (auto adj : graph.getAdjacentOf(node)) {
-        std::pair<int, int> edge = std::minmax(node, adj.first);
+                                            std::vector<BuildNode> &niceNodes) {
+    for (unsigned arc = graph.arcBegin(node); arc < graph.arcEnd(node); arc++) {
+        std::pair<int, int> edge = std::minmax(node, graph.arcTarget(arc));
         if (enabledEdges.count(edge) == 0) {
             enabledEdges.insert(edge);
             continue;
@@ -267,21 +737,26 @@ unsigned TreeDecomposition::getNodeCount() const {
     return nodeCount;
 }
 
-const TreeDecomposition::Node &TreeDecomposition::getNodeAt(int id) const {
-    return nodes[id];
+TreeDecomposition::Node TreeDecomposition::getNodeAt(int id) const {
+    return {getBagOf(id), getAdjacentTo(id), (NodeType)types[id], associatedNodes[id], associatedEdges[id], indices[id]};
+}
+
+const TreeDecomposition::NodeIndex &TreeDecomposition::getIndexOf(int id) const {
+    return indices[id];
 }
 
 unsigned int TreeDecomposition::getWidth() const {
     return width;
 }
 
-void TreeDecomposition::removeErasedNodes(const Graph &graph) {
-    // remove nodes from the bags
-    for (auto& node : nodes) {
+void TreeDecomposition::removeErasedNodes(const Graph &graph, std::vector<BuildNode> &uglyNodes) {
+    // remove nodes from the bags, contracted ones are replaced by the node they were merged into
+    for (auto& node : uglyNodes) {
         std::vector<int> newBag;
         for (auto elem : node.bag) {
-            if (!graph.isNodeErased(elem)) {
-                newBag.push_back(elem);
+            int substitute = graph.substituteOf(elem);
+            if (substitute != -1 && std::find(newBag.begin(), newBag.end(), substitute) == newBag.end()) {
+                newBag.push_back(substitute);
             }
         }
         node.bag = newBag;
@@ -289,7 +764,7 @@ void TreeDecomposition::removeErasedNodes(const Graph &graph) {
 
     // update width
     width = 0;
-    for (auto& node : nodes) {
+    for (auto& node : uglyNodes) {
         width = std::max((unsigned)node.bag.size(), width);
     }
 }
@@ -12,53 +12,144 @@
 #include <string>
 #include <vector>
 
+#include "utility/array_view.h"
+#include "utility/elimination_ordering.h"
 #include "utility/helpers.h"
 #include "structures/graph.h"
+#include "utility/input_reader.h"
+#include "utility/snapshot.h"
 
 class TreeDecomposition {
 public:
-    TreeDecomposition() : nodeCount(0), width(0), origNodes(0) {}
+    TreeDecomposition() : nodeCount(0), width(0), origNodes(0), bagOffsets(1, 0), adjacentOffsets(1, 0) {}
 
     void load(std::istream &input);
+    void load(InputReader &input);
+
+    /**
+     * Builds the decomposition from a greedy elimination ordering of the graph, for inputs that
+     * come without one. The budget is in seconds.
+     */
+    void computeHeuristic(const Graph &graph, double timeBudget);
+
+    /**
+     * Narrows the loaded decomposition within the budget in seconds. Bags contained in a neighbour
+     * are merged into it, and the largest bags are replaced by a decomposition of their torso
+     * (the bag with every separator to a neighbour made a clique) whenever that one is narrower.
+     */
+    void improve(const Graph &graph, double timeBudget);
     void convertToNice(const Graph &sourceGraph);
 
+    /**
+     * Number of DP states the cost model expects over the whole nice decomposition, joins are
+     * counted by the pairs of states they combine
+     */
+    double estimateDPStates(const Graph &graph) const;
+
+    /**
+     * Stores the decomposition as flat arrays: node types, associated vertices and edges, and a
+     * pool of bags and children addressed by offsets
+     */
+    void saveSnapshot(SnapshotWriter &output) const;
+    void loadSnapshot(SnapshotReader &input);
+
     void printTree(std::ostream& output);
 
-    const std::vector<int> &getAdjacentTo(int node) const;
-    const std::vector<int> &getBagOf(int node) const;
+    ArrayView<int> getAdjacentTo(int node) const;
+    ArrayView<int> getBagOf(int node) const;
     unsigned getNodeCount() const;
 
     enum NodeType {NOT_NICE, INTRO, FORGET, JOIN, INTRO_EDGE, LEAF};
 
+    /**
+     * Positions and lookups the solvers need for every state of a nice node, filled in once by
+     * convertToNice so that no bag has to be searched during the DP
+     */
+    struct NodeIndex {
+        // child ids, -1 when missing
+        int children[2] = {-1, -1};
+        // bits of the bag positions (below 32) that hold terminals
+        unsigned termMask = 0;
+        // INTRO: position of the introduced node in the bag, FORGET: of the forgotten one in the child's bag
+        unsigned position = 0;
+        // INTRO_EDGE: bag positions of both endpoints, weight and id of the edge
+        unsigned edgePositions[2] = {0, 0};
+        unsigned edgeWeight = 0;
+        int edgeId = -1;
+    };
+
+    /**
+     * View of a single node, its bag and children point into the shared pools
+     */
     struct Node {
-        Node() : type(NOT_NICE), associatedNode(-1) {}
-        std::vector<int> bag, adjacent;
+        ArrayView<int> bag, adjacent;
         NodeType type;
         int associatedNode;
         std::pair<int, int> associatedEdge;
+        const NodeIndex &index;
     };
 
-    const Node& getNodeAt(int id) const;
+    Node getNodeAt(int id) const;
+    const NodeIndex &getIndexOf(int id) const;
     unsigned int getWidth() const;
 
 private:
+    // node under construction, all of them are frozen into the flat arrays once complete
+    struct BuildNode {
+        BuildNode() : type(NOT_NICE), associatedNode(-1) {}
+        std::vector<int> bag, adjacent;
+        NodeType type;
+        int associatedNode;
+        std::pair<int, int> associatedEdge;
+    };
+
+    void freeze(const std::vector<BuildNode> &built);
+    std::vector<BuildNode> thaw() const;
 
-    void beautifyDFS(int &currId,
-                     int uglyNode,
-                     int uglyParent,
-                     std::vector<Node> &niceNodes,
-                     const Graph &graph);
+    size_t countNiceNodes(int uglyRoot, const Graph &graph) const;
+    void beautify(int uglyRoot,
+                  const std::vector<double> &subtreeStates,
+                  std::vector<BuildNode> &niceNodes,
+                  const Graph &graph);
+
+    /**
+     * Cost model of the conversion: a bag is estimated by the number of (subset, partition) states the
+     * rank based DP keeps for it, terminals are always in the subset, other nodes may stay out of it
+     */
+    static double estimateStates(ArrayView<int> bag, const Graph &graph,
+                                 double terminalWeight = 2, double otherWeight = 3);
+    /**
+     * Leaf bag to root the conversion at, -1 if the decomposition has no leaf
+     */
+    int chooseRoot(const Graph &graph) const;
+    std::vector<double> estimateSubtrees(int uglyRoot, const Graph &graph) const;
 
     void addIntroEdgesOfNode(int &currId,
                              int node,
                              const std::vector<int> &bag,
                              const Graph &graph,
-                             std::vector<Node> &niceNodes);
-    void removeErasedNodes(const Graph& graph);
+                             std::vector<BuildNode> &niceNodes);
+    void removeErasedNodes(const Graph& graph, std::vector<BuildNode> &uglyNodes);
+    void removeRedundantBags(std::vector<BuildNode> &nodes, std::vector<bool> &removed) const;
+    bool retriangulate(int node, const Graph &graph, std::vector<BuildNode> &nodes) const;
+    void indexNodes(const Graph &graph);
 
     unsigned nodeCount, width, origNodes;
-    std::vector<Node> nodes;
+
+    // struct of arrays, bags and children of node i are [offsets[i], offsets[i + 1]) of the pools
+    std::vector<unsigned> bagOffsets, adjacentOffsets;
+    std::vector<int> bagPool, adjacentPool;
+    std::vector<uint8_t> types;
+    std::vector<int> associatedNodes;
+    std::vector<std::pair<int, int>> associatedEdges;
+    std::vector<NodeIndex> indices;
+
     std::set<std::pair<int, int>> enabledEdges;
+
+    // seconds of elimination heuristics spent on a single torso
+    static constexpr double TORSO_BUDGET = 0.01;
+    // bags smaller than the width by more than this are left as they are
+    static const size_t RETRIANGULATE_SLACK = 2;
 };
 
 
@@ -1,7 +1,7 @@
 #include "utility/terminals_stdio_runner.h"
 
-int main() {
+int main(int argc, char **argv) {
     TerminalsStdioRunner runner;
-    runner.run();
+    runner.run(argc > 1 ? argv[1] : nullptr);
     return 0;
 }
\ No newline at end of file
@@ -1,7 +1,20 @@
 #include "utility/treewidth_stdio_runner.h"
 
-int main() {
+#include <string>
+
+int main(int argc, char **argv) {
     TreewidthStdioRunner runner;
-    runner.run();
+    const char *inputPath = nullptr;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--snapshot" && i + 1 < argc) {
+            runner.setSnapshotInput(argv[++i]);
+        } else if (arg == "--save-snapshot" && i + 1 < argc) {
+            runner.setSnapshotOutput(argv[++i]);
+        } else {
+            inputPath = argv[i];
+        }
+    }
+    runner.run(inputPath);
     return 0;
 }
\ No newline at end of file
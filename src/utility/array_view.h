@@ -0,0 +1,75 @@
+#ifndef PACE2018_ARRAY_VIEW_H
+#define PACE2018_ARRAY_VIEW_H
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * Read-only view of a contiguous range of elements owned elsewhere
+ */
+template <typename T>
+class ArrayView {
+public:
+    typedef const T* iterator;
+    typedef const T* const_iterator;
+    typedef T value_type;
+
+    ArrayView() : first(nullptr), count(0) {}
+    ArrayView(const T *first, size_t count) : first(first), count(count) {}
+
+    const T *begin() const {
+        return first;
+    }
+
+    const T *end() const {
+        return first + count;
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+    bool empty() const {
+        return count == 0;
+    }
+
+    const T &operator[](size_t idx) const {
+        return first[idx];
+    }
+
+    const T &back() const {
+        return first[count - 1];
+    }
+
+    std::vector<T> toVector() const {
+        return std::vector<T>(begin(), end());
+    }
+
+    bool operator==(const ArrayView &other) const {
+        if (count != other.count) {
+            return false;
+        }
+        for (size_t i = 0; i < count; i++) {
+            if (!(first[i] == other.first[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool operator==(const std::vector<T> &other) const {
+        return *this == ArrayView(other.data(), other.size());
+    }
+
+private:
+    const T *first;
+    size_t count;
+};
+
+template <typename T>
+bool operator==(const std::vector<T> &vector, const ArrayView<T> &view) {
+    return view == vector;
+}
+
+
+#endif //PACE2018_ARRAY_VIEW_H
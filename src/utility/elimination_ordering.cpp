@@ -0,0 +1,171 @@
+#include "elimination_ordering.h"
+
+#include <algorithm>
+#include <tuple>
+
+EliminationOrdering::EliminationOrdering(const Graph &graph)
+        : adjacency((size_t)graph.getNodeCount()), active((size_t)graph.getNodeCount()), bestWidth(0) {
+    for (int node = 0; node < graph.getNodeCount(); node++) {
+        active[node] = !graph.isNodeErased(node);
+        for (unsigned arc = graph.arcBegin(node); arc < graph.arcEnd(node); arc++) {
+            adjacency[node].push_back(graph.arcTarget(arc));
+        }
+    }
+}
+
+EliminationOrdering::EliminationOrdering(std::vector<std::vector<int>> adjacency)
+        : adjacency(std::move(adjacency)), active(this->adjacency.size(), true), bestWidth(0) {}
+
+void EliminationOrdering::compute(double timeBudget) {
+    clock_t deadline = clock() + (clock_t)(timeBudget * CLOCKS_PER_SEC);
+    std::vector<int> order;
+    std::vector<std::vector<int>> bags;
+    unsigned width;
+
+    // min-degree is cheap and always finishes, it is the fallback for the rest
+    eliminate(false, nullptr, deadline, bestOrder, bestBags, bestWidth);
+
+    std::mt19937 random(2018);
+    for (unsigned run = 0; run <= MAX_RANDOM_RUNS && clock() < deadline; run++) {
+        if (!eliminate(true, run == 0 ? nullptr : &random, deadline, order, bags, width)) {
+            break;
+        }
+        if (width < bestWidth) {
+            bestWidth = width;
+            bestOrder.swap(order);
+            bestBags.swap(bags);
+        }
+    }
+}
+
+const std::vector<int> &EliminationOrdering::getOrder() const {
+    return bestOrder;
+}
+
+unsigned EliminationOrdering::getWidth() const {
+    return bestWidth;
+}
+
+void EliminationOrdering::getDecomposition(std::vector<std::vector<int>> &bags,
+                                           std::vector<std::pair<int, int>> &treeEdges) const {
+    bags = bestBags;
+    treeEdges.clear();
+
+    // nodes left when min-degree ran out of time all belong to the last bag
+    std::vector<int> position(adjacency.size(), -1);
+    for (unsigned i = 0; i < bestOrder.size(); i++) {
+        position[bestOrder[i]] = std::min(i, (unsigned)bags.size() - 1);
+    }
+
+    // the first eliminated neighbour always sees the rest of the bag, roots get chained together
+    int lastRoot = -1;
+    for (unsigned i = 0; i < bags.size(); i++) {
+        int parent = -1;
+        for (auto node : bags[i]) {
+            if (position[node] > (int)i && (parent == -1 || position[node] < parent)) {
+                parent = position[node];
+            }
+        }
+        if (parent == -1) {
+            if (lastRoot != -1) {
+                treeEdges.emplace_back(lastRoot, i);
+            }
+            lastRoot = i;
+            continue;
+        }
+        treeEdges.emplace_back(i, parent);
+    }
+}
+
+bool EliminationOrdering::eliminate(bool minFill, std::mt19937 *random, clock_t deadline,
+                                    std::vector<int> &order, std::vector<std::vector<int>> &bags,
+                                    unsigned &width) const {
+    auto nodeCount = (int)adjacency.size();
+    std::vector<std::set<int>> adjacent((size_t)nodeCount);
+    for (int node = 0; node < nodeCount; node++) {
+        adjacent[node].insert(adjacency[node].begin(), adjacency[node].end());
+    }
+
+    // (score, tie breaker, node), the tie breaker stays fixed for the whole run
+    std::vector<unsigned> score((size_t)nodeCount), tie((size_t)nodeCount, 0);
+    std::set<std::tuple<unsigned, unsigned, int>> queue;
+    for (int node = 0; node < nodeCount; node++) {
+        if (!active[node]) {
+            continue;
+        }
+        if (random != nullptr) {
+            tie[node] = (unsigned)(*random)();
+        }
+        score[node] = minFill ? fillIn(node, adjacent) : (unsigned)adjacent[node].size();
+        queue.emplace(score[node], tie[node], node);
+    }
+
+    order.clear();
+    bags.clear();
+    width = 0;
+    std::vector<int> touched;
+    while (!queue.empty()) {
+        if (clock() > deadline) {
+            if (minFill) {
+                return false;
+            }
+            // out of time, the nodes left share one bag as if they were a clique already
+            std::vector<int> rest;
+            for (auto &entry : queue) {
+                rest.push_back(std::get<2>(entry));
+            }
+            order.insert(order.end(), rest.begin(), rest.end());
+            width = std::max(width, (unsigned)rest.size());
+            bags.push_back(std::move(rest));
+            return true;
+        }
+
+        int node = std::get<2>(*queue.begin());
+        queue.erase(queue.begin());
+
+        // the node with its neighbourhood forms the bag, the neighbourhood becomes a clique
+        std::vector<int> bag(adjacent[node].begin(), adjacent[node].end());
+        for (auto neighbour : bag) {
+            adjacent[neighbour].erase(node);
+            adjacent[neighbour].insert(bag.begin(), bag.end());
+            adjacent[neighbour].erase(neighbour);
+        }
+        adjacent[node].clear();
+        bag.push_back(node);
+        width = std::max(width, (unsigned)bag.size());
+        order.push_back(node);
+
+        // fill-in can change up to two steps away, the degree only in the neighbourhood
+        touched.assign(bag.begin(), bag.end() - 1);
+        if (minFill) {
+            for (unsigned i = 0, size = (unsigned)touched.size(); i < size; i++) {
+                touched.insert(touched.end(), adjacent[touched[i]].begin(), adjacent[touched[i]].end());
+            }
+            std::sort(touched.begin(), touched.end());
+            touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+        }
+        for (auto other : touched) {
+            unsigned newScore = minFill ? fillIn(other, adjacent) : (unsigned)adjacent[other].size();
+            if (newScore != score[other]) {
+                queue.erase(std::make_tuple(score[other], tie[other], other));
+                score[other] = newScore;
+                queue.emplace(newScore, tie[other], other);
+            }
+        }
+
+        bags.push_back(std::move(bag));
+    }
+    return true;
+}
+
+unsigned EliminationOrdering::fillIn(int node, const std::vector<std::set<int>> &adjacent) const {
+    unsigned missing = 0;
+    for (auto first = adjacent[node].begin(); first != adjacent[node].end(); ++first) {
+        for (auto second = std::next(first); second != adjacent[node].end(); ++second) {
+            if (adjacent[*first].count(*second) == 0) {
+                missing++;
+            }
+        }
+    }
+    return missing;
+}
@@ -0,0 +1,72 @@
+#ifndef PACE2018_ELIMINATION_ORDERING_H
+#define PACE2018_ELIMINATION_ORDERING_H
+
+#include <ctime>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "structures/graph.h"
+
+/**
+ * Greedy elimination orderings of the live nodes of a graph, used to build a tree decomposition
+ * when the input comes without one
+ *
+ * Eliminating a node turns its remaining neighbourhood into a clique, the node together with that
+ * neighbourhood forms a bag. Min-degree picks the node with the fewest neighbours, min-fill the
+ * one adding the fewest edges.
+ */
+class EliminationOrdering {
+public:
+    /**
+     * Orders the live nodes of the graph
+     */
+    explicit EliminationOrdering(const Graph &graph);
+
+    /**
+     * Orders the nodes of the graph given by its adjacency lists
+     */
+    explicit EliminationOrdering(std::vector<std::vector<int>> adjacency);
+
+    /**
+     * Runs min-degree and min-fill, then randomized min-fill while the budget in seconds lasts,
+     * keeping the narrowest ordering found. Min-degree always gives an ordering, if the budget runs
+     * out during it the nodes not eliminated yet go into one final bag.
+     */
+    void compute(double timeBudget);
+
+    const std::vector<int> &getOrder() const;
+
+    /**
+     * Size of the largest bag of the best ordering
+     */
+    unsigned getWidth() const;
+
+    /**
+     * Bags of the best ordering, one per eliminated node, each attached to the bag of its neighbour
+     * eliminated first. Components of the elimination forest are chained into one tree. Nodes left
+     * by a min-degree run out of time share the last bag.
+     */
+    void getDecomposition(std::vector<std::vector<int>> &bags, std::vector<std::pair<int, int>> &treeEdges) const;
+
+private:
+    /**
+     * Eliminates all nodes greedily by the chosen score, random numbers break ties if given.
+     * Past the deadline min-fill returns false, min-degree puts the remaining nodes into one bag.
+     */
+    bool eliminate(bool minFill, std::mt19937 *random, clock_t deadline,
+                   std::vector<int> &order, std::vector<std::vector<int>> &bags, unsigned &width) const;
+    unsigned fillIn(int node, const std::vector<std::set<int>> &adjacent) const;
+
+    std::vector<std::vector<int>> adjacency;
+    std::vector<bool> active;
+    std::vector<int> bestOrder;
+    std::vector<std::vector<int>> bestBags;
+    unsigned bestWidth;
+
+    static const unsigned MAX_RANDOM_RUNS = 32;
+};
+
+
+#endif //PACE2018_ELIMINATION_ORDERING_H
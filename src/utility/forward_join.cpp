@@ -0,0 +1,58 @@
+#include "forward_join.h"
+
+#include "utility/partition_mergers.h"
+
+void ForwardJoin::compute() {
+    uint64_t count = partitionCount(size);
+    result.assign(count, infinity);
+    choices.assign(count, {0, 0});
+
+    // only reachable child states take part
+    std::vector<State> states1, states2;
+    collect(costs1, states1);
+    collect(costs2, states2);
+
+    const PartitionCatalogue &catalogue = PartitionCatalogue::get();
+    bool small = size <= PartitionCatalogue::MAX_JOIN_SIZE;
+    UnionFindMerger merger(size, lowBits(size));
+    for (auto &p1 : states1) {
+        for (auto &p2 : states2) {
+            uint64_t merged;
+            if (small) {
+                unsigned index = catalogue.joined(size, (unsigned)p1.rank, (unsigned)p2.rank);
+                if (index == PartitionCatalogue::NONE) {
+                    continue;
+                }
+                merged = index;
+            } else {
+                uint64_t partition = merger.join(p1.partition, p2.partition);
+                if (partition == PARTITION_INVALID) {
+                    continue;
+                }
+                merged = rankPartition(partition, size);
+            }
+
+            unsigned candidate = p1.cost + p2.cost;
+            if (candidate < result[merged]) {
+                result[merged] = candidate;
+                choices[merged] = {p1.rank, p2.rank};
+            }
+        }
+    }
+}
+
+const std::vector<unsigned> &ForwardJoin::getResult() const {
+    return result;
+}
+
+std::pair<uint64_t, uint64_t> ForwardJoin::getChoice(uint64_t rank) const {
+    return choices[rank];
+}
+
+void ForwardJoin::collect(const std::vector<unsigned> &costs, std::vector<State> &states) const {
+    for (uint64_t rank = 0; rank < costs.size(); rank++) {
+        if (costs[rank] < infinity) {
+            states.push_back({costs[rank], rank, unrankPartition(rank, size)});
+        }
+    }
+}
@@ -0,0 +1,55 @@
+#ifndef PACE2018_FORWARD_JOIN_H
+#define PACE2018_FORWARD_JOIN_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "utility/helpers.h"
+#include "utility/partition_catalogue.h"
+
+/**
+ * How a JOIN node combines the states of its children. Refinements looks at every partition of the parent
+ * on its own, pairing up the refinements of it. Forward merges every pair of finite child states once and
+ * finishes all parent partitions of the subset together.
+ */
+enum class JoinEngine {
+    REFINEMENTS,
+    FORWARD
+};
+
+/**
+ * All parent states of a JOIN node for one subset at once
+ *
+ * Costs of both children come indexed by the rank of the compressed partition, see rankPartition, the result
+ * is indexed the same way. Pairs whose merge closes a cycle are skipped, the rest lands on their join.
+ */
+class ForwardJoin {
+public:
+    ForwardJoin(const std::vector<unsigned> &costs1, const std::vector<unsigned> &costs2,
+                unsigned size, unsigned infinity)
+            : costs1(costs1), costs2(costs2), size(size), infinity(infinity) {}
+    void compute();
+    const std::vector<unsigned> &getResult() const;
+
+    /**
+     * Ranks of the child partitions the best cost of the parent partition comes from
+     */
+    std::pair<uint64_t, uint64_t> getChoice(uint64_t rank) const;
+
+private:
+    struct State {
+        unsigned cost;
+        uint64_t rank, partition;
+    };
+
+    void collect(const std::vector<unsigned> &costs, std::vector<State> &states) const;
+
+    const std::vector<unsigned> &costs1, &costs2;
+    unsigned size, infinity;
+    std::vector<unsigned> result;
+    std::vector<std::pair<uint64_t, uint64_t>> choices;
+};
+
+
+#endif //PACE2018_FORWARD_JOIN_H
@@ -7,6 +7,12 @@
 #include <stack>
 #include <vector>
 
+#ifdef __BMI2__
+#include <immintrin.h>
+#endif
+
+#include "utility/partition_traits.h"
+
 /**
  * Divides two vectors into intersection, and exclusives
  */
@@ -30,26 +36,27 @@ inline bool isInSubset(unsigned idx, unsigned subset) {
     return (bool)((subset & (1u << idx)) != 0);
 }
 
-inline std::vector<char> partitionToVec(unsigned size, uint64_t partition) {
+template <typename Partition>
+std::vector<char> partitionToVec(unsigned size, const Partition &partition) {
     std::vector<char> vec;
     for (unsigned i = 0; i < size; ++i) {
-        uint64_t value = (partition & (0xFull << (i << 2u))) >> (i << 2u);
-        vec.push_back((char)value);
+        vec.push_back((char)PartitionTraits<Partition>::get(partition, i));
     }
     return vec;
 }
 
-inline int getComponentAt(uint64_t partition, unsigned at) {
-    uint64_t comp = (partition & (0xFULL << (at << 2u))) >> (at << 2u);
-    return (int)comp;
+template <typename Partition>
+int getComponentAt(const Partition &partition, unsigned at) {
+    return (int)PartitionTraits<Partition>::get(partition, at);
 }
 
-inline void setComponentAt(uint64_t& partition, unsigned at, unsigned char to) {
-    partition &= ~(0xFULL << (at << 2u));
-    partition |= ((uint64_t)to) << (at << 2u);
+template <typename Partition>
+void setComponentAt(Partition &partition, unsigned at, unsigned char to) {
+    PartitionTraits<Partition>::set(partition, at, to);
 }
 
-inline int maxComponentIn(uint64_t partition, unsigned size) {
+template <typename Partition>
+int maxComponentIn(const Partition &partition, unsigned size) {
     int result = 0;
     for (unsigned i = 0; i < size; ++i) {
         result = std::max(result, getComponentAt(partition, i));
@@ -57,7 +64,11 @@ inline int maxComponentIn(uint64_t partition, unsigned size) {
     return result;
 }
 
-inline uint64_t vecToPartition(const std::vector<char> &vec, unsigned subset) {
+/**
+ * Canonical partition of the vector restricted to the subset, components numbered by first occurrence
+ */
+template <typename Partition = uint64_t>
+Partition vecToPartition(const std::vector<char> &vec, unsigned subset) {
     // canonize the vector
     std::map<char, char> partMap;
     unsigned counter = 0, idx = 0;
@@ -69,51 +80,274 @@ inline uint64_t vecToPartition(const std::vector<char> &vec, unsigned subset) {
         }
     }
 
-    // translate to integer type
-    uint64_t part = 0;
-    unsigned shift = 0;
+    // translate to the packed type
+    Partition part{};
     idx = 0;
     for (char i : vec) {
-        if ((subset & (1u << idx++)) != 0) {
-            part |= ((uint64_t) partMap[i]) << shift;
+        if ((subset & (1u << idx)) != 0) {
+            PartitionTraits<Partition>::set(part, idx, (unsigned)partMap[i]);
         }
-        shift += 4;
+        idx++;
     }
     return part;
 }
 
-inline uint64_t partitionWithoutElement(const std::vector<char> &vec, int id, unsigned subset) {
+template <typename Partition = uint64_t>
+Partition partitionWithoutElement(const std::vector<char> &vec, int id, unsigned subset) {
     std::vector<char> newVec = vec;
     newVec.erase(newVec.begin() + id);
-    return vecToPartition(newVec, subset);
+    return vecToPartition<Partition>(newVec, subset);
 }
 
-inline unsigned maskWithoutElement(unsigned mask, unsigned id, unsigned size) {
-    unsigned shift = 0, result = 0;
-    for (unsigned i = 0; i < size; i++) {
-        if (i == id) {
-            continue;
-        }
-        result |= (unsigned)((mask & (1u << i)) != 0) << shift;
-        shift++;
+/**
+ * Scatters the low bits of the value to the set bits of the mask, PDEP where the target has BMI2
+ */
+inline unsigned depositBits(unsigned value, unsigned mask) {
+#ifdef __BMI2__
+    return _pdep_u32(value, mask);
+#else
+    unsigned result = 0;
+    for (unsigned bit = 1; mask != 0; bit <<= 1u, mask &= mask - 1) {
+        result |= (mask & -mask) & -(unsigned)((value & bit) != 0);
     }
     return result;
+#endif
 }
 
-inline unsigned maskWithElement(unsigned mask, unsigned id, unsigned value, unsigned size) {
-    unsigned shift = 0, result = 0;
-    for (unsigned i = 0; i < size; i++) {
-        if (i == id) {
-            result |= (value << shift);
-            shift++;
+/**
+ * Gathers the bits of the value under the mask to the low bits, PEXT where the target has BMI2
+ */
+inline unsigned extractBits(unsigned value, unsigned mask) {
+#ifdef __BMI2__
+    return _pext_u32(value, mask);
+#else
+    unsigned result = 0;
+    for (unsigned bit = 1; mask != 0; bit <<= 1u, mask &= mask - 1) {
+        result |= bit & -(unsigned)((value & mask & -mask) != 0);
+    }
+    return result;
+#endif
+}
+
+/**
+ * Mask of the nibbles of a 4-bit partition that belong to the subset
+ */
+inline uint64_t subsetNibbles(unsigned subset) {
+#ifdef __BMI2__
+    return _pdep_u64(subset, 0x1111111111111111ull) * 0xF;
+#else
+    uint64_t result = 0;
+    for (unsigned i = 0; i < 16; i++) {
+        result |= (uint64_t)((subset >> i) & 1u) << (i << 2u);
+    }
+    return result * 0xF;
+#endif
+}
+
+/**
+ * Packs the nibbles of the subset members next to each other, the i-th member takes the i-th nibble
+ */
+inline uint64_t compressPartition(uint64_t partition, unsigned subset) {
+#ifdef __BMI2__
+    return _pext_u64(partition, subsetNibbles(subset));
+#else
+    uint64_t result = 0;
+    unsigned shift = 0;
+    for (; subset != 0; subset &= subset - 1, shift += 4) {
+        result |= ((partition >> ((unsigned)__builtin_ctz(subset) << 2u)) & 0xFu) << shift;
+    }
+    return result;
+#endif
+}
+
+/**
+ * Inverse of compressPartition, vertices outside of the subset get zero
+ */
+inline uint64_t expandPartition(uint64_t compressed, unsigned subset) {
+#ifdef __BMI2__
+    return _pdep_u64(compressed, subsetNibbles(subset));
+#else
+    uint64_t result = 0;
+    unsigned shift = 0;
+    for (; subset != 0; subset &= subset - 1, shift += 4) {
+        result |= ((compressed >> shift) & 0xFu) << ((unsigned)__builtin_ctz(subset) << 2u);
+    }
+    return result;
+#endif
+}
+
+/**
+ * Number of ways to finish a restricted growth string with the given number of elements left
+ * and blocks already opened, rank and unrank walk these counts
+ */
+struct PartitionCompletions {
+    static const unsigned MAX_SIZE = 16;
+    uint64_t count[MAX_SIZE + 1][MAX_SIZE + 2];
+
+    constexpr PartitionCompletions() : count() {
+        for (unsigned blocks = 0; blocks <= MAX_SIZE + 1; blocks++) {
+            count[0][blocks] = 1;
+        }
+        for (unsigned left = 1; left <= MAX_SIZE; left++) {
+            for (unsigned blocks = 0; blocks <= MAX_SIZE - left + 1; blocks++) {
+                count[left][blocks] = blocks * count[left - 1][blocks] + count[left - 1][blocks + 1];
+            }
         }
-        result |= (unsigned)((mask & (1u << i)) != 0) << shift;
-        shift++;
     }
-    if (size == id) {
-        result |= (value << shift);
+};
+
+inline constexpr PartitionCompletions PARTITION_COMPLETIONS;
+
+/**
+ * Number of partitions of the given number of elements, the Bell number
+ */
+inline uint64_t partitionCount(unsigned size) {
+    return PARTITION_COMPLETIONS.count[size][0];
+}
+
+/**
+ * Position of a canonical compressed partition among all partitions of its size, in lexicographic
+ * order of the restricted growth strings with the first element most significant
+ */
+inline uint64_t rankPartition(uint64_t compressed, unsigned size) {
+    uint64_t rank = 0;
+    unsigned blocks = 0;
+    for (unsigned at = 0; at < size; at++, compressed >>= 4u) {
+        auto component = (unsigned)(compressed & 0xFu);
+        // every smaller component is an already opened block
+        rank += component * PARTITION_COMPLETIONS.count[size - at - 1][blocks];
+        blocks = std::max(blocks, component + 1);
+    }
+    return rank;
+}
+
+/**
+ * Inverse of rankPartition
+ */
+inline uint64_t unrankPartition(uint64_t rank, unsigned size) {
+    uint64_t compressed = 0;
+    unsigned blocks = 0;
+    for (unsigned at = 0; at < size; at++) {
+        uint64_t completions = PARTITION_COMPLETIONS.count[size - at - 1][blocks];
+        unsigned component = blocks;
+        if (rank < blocks * completions) {
+            component = (unsigned)(rank / completions);
+            rank -= component * completions;
+        } else {
+            rank -= blocks * completions;
+            blocks++;
+        }
+        compressed |= (uint64_t)component << (at << 2u);
+    }
+    return compressed;
+}
+
+inline unsigned lowBits(unsigned count) {
+    return count >= 32 ? ~0u : (1u << count) - 1;
+}
+
+/**
+ * Canonical form of a packed partition restricted to the subset, components numbered by first occurrence
+ */
+template <typename Partition>
+Partition canonizePartition(const Partition &partition, unsigned subset, unsigned size) {
+    unsigned char mapping[256];
+    std::fill(mapping, mapping + 256, 0xFF);
+    Partition result{};
+    unsigned char next = 0;
+    for (unsigned members = subset & lowBits(size); members != 0; members &= members - 1) {
+        auto at = (unsigned)__builtin_ctz(members);
+        unsigned component = PartitionTraits<Partition>::get(partition, at);
+        if (mapping[component] == 0xFF) {
+            mapping[component] = next++;
+        }
+        PartitionTraits<Partition>::set(result, at, mapping[component]);
+    }
+    return result;
+}
+
+inline uint64_t canonizePartition(const uint64_t &partition, unsigned subset, unsigned size) {
+    // the relabeling is kept in the nibbles of a register, seen components in a bitmask
+    uint64_t mapping = 0, result = 0;
+    unsigned seen = 0, next = 0;
+    for (unsigned members = subset & lowBits(size); members != 0; members &= members - 1) {
+        unsigned shift = (unsigned)__builtin_ctz(members) << 2u;
+        unsigned component = (unsigned)(partition >> shift) & 0xFu;
+        unsigned fresh = ~(seen >> component) & 1u;
+        mapping |= (uint64_t)(next & -fresh) << (component << 2u);
+        seen |= fresh << component;
+        next += fresh;
+        result |= ((mapping >> (component << 2u)) & 0xFu) << shift;
+    }
+    return result;
+}
+
+/**
+ * Inserts a vertex with the given component before position at, the result is not canonical
+ */
+template <typename Partition>
+Partition insertComponentAt(const Partition &partition, unsigned at, unsigned value, unsigned size) {
+    Partition result = partition;
+    for (unsigned i = size; i > at; i--) {
+        PartitionTraits<Partition>::set(result, i, PartitionTraits<Partition>::get(partition, i - 1));
+    }
+    PartitionTraits<Partition>::set(result, at, value);
+    return result;
+}
+
+inline uint64_t insertComponentAt(const uint64_t &partition, unsigned at, unsigned value, unsigned) {
+    uint64_t low = (1ull << (at << 2u)) - 1;
+    return (partition & low) | ((uint64_t)value << (at << 2u)) | ((partition & ~low) << 4u);
+}
+
+/**
+ * Removes the vertex at the position, the following ones move down, the result is not canonical
+ */
+template <typename Partition>
+Partition eraseComponentAt(const Partition &partition, unsigned at, unsigned size) {
+    Partition result = partition;
+    for (unsigned i = at; i + 1 < size; i++) {
+        PartitionTraits<Partition>::set(result, i, PartitionTraits<Partition>::get(partition, i + 1));
+    }
+    PartitionTraits<Partition>::set(result, size - 1, 0);
+    return result;
+}
+
+inline uint64_t eraseComponentAt(const uint64_t &partition, unsigned at, unsigned) {
+    uint64_t low = (1ull << (at << 2u)) - 1;
+    return (partition & low) | ((partition >> 4u) & ~low);
+}
+
+/**
+ * Moves the vertices of the subset in component from to component to, the result is not canonical
+ */
+template <typename Partition>
+Partition relabelComponent(const Partition &partition, unsigned from, unsigned to, unsigned subset, unsigned size) {
+    Partition result = partition;
+    for (unsigned members = subset & lowBits(size); members != 0; members &= members - 1) {
+        auto at = (unsigned)__builtin_ctz(members);
+        if (PartitionTraits<Partition>::get(partition, at) == from) {
+            PartitionTraits<Partition>::set(result, at, to);
+        }
     }
     return result;
 }
 
+inline uint64_t relabelComponent(const uint64_t &partition, unsigned from, unsigned to, unsigned subset, unsigned) {
+    // nibbles equal to from become zero, their lowest bit marks the match
+    uint64_t diff = partition ^ (from * 0x1111111111111111ull);
+    diff |= diff >> 1u;
+    diff |= diff >> 2u;
+    uint64_t matches = ~diff & subsetNibbles(subset) & 0x1111111111111111ull;
+    return partition ^ (matches * (from ^ to));
+}
+
+inline unsigned maskWithoutElement(unsigned mask, unsigned id, unsigned size) {
+    return extractBits(mask, lowBits(size) & ~(1u << id));
+}
+
+inline unsigned maskWithElement(unsigned mask, unsigned id, unsigned value, unsigned size) {
+    return depositBits(mask, lowBits(size + 1) & ~(1u << id)) | (value << id);
+}
+
 #endif //PACE2018_HELPERS_H
@@ -0,0 +1,166 @@
+#include "input_reader.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+InputReader::InputReader(int fd) : data(nullptr), size(0), pos(0), mapped(nullptr) {
+    const size_t blockSize = 1u << 20u;
+    while (true) {
+        storage.resize(size + blockSize);
+        ssize_t got = read(fd, storage.data() + size, blockSize);
+        if (got == -1 && errno == EINTR) {
+            continue;
+        }
+        if (got == -1) {
+            std::cerr << "Cannot read input: " << std::strerror(errno) << std::endl;
+            exit(1);
+        }
+        if (got == 0) {
+            break;
+        }
+        size += (size_t)got;
+    }
+    storage.resize(size);
+    data = storage.data();
+}
+
+InputReader::InputReader(const std::string &path) : data(nullptr), size(0), pos(0), mapped(nullptr) {
+    int fd = open(path.c_str(), O_RDONLY);
+    struct stat info = {};
+    if (fd == -1 || fstat(fd, &info) != 0) {
+        std::cerr << "Cannot open input file " << path << std::endl;
+        exit(1);
+    }
+    size = (size_t)info.st_size;
+    if (size != 0) {
+        mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            std::cerr << "Cannot map input file " << path << std::endl;
+            exit(1);
+        }
+        data = static_cast<const char*>(mapped);
+    }
+    close(fd);
+}
+
+InputReader::InputReader(std::istream &input, unsigned sectionCount)
+        : data(nullptr), size(0), pos(0), mapped(nullptr) {
+    std::string line;
+    while (sectionCount > 0 && std::getline(input, line)) {
+        size_t first = line.find_first_not_of(" \t\r");
+        if (first != std::string::npos && line.compare(first, 3, "END") == 0) {
+            sectionCount--;
+        }
+        storage.insert(storage.end(), line.begin(), line.end());
+        storage.push_back('\n');
+    }
+    size = storage.size();
+    data = storage.data();
+}
+
+InputReader::~InputReader() {
+    if (mapped != nullptr) {
+        munmap(mapped, size);
+    }
+}
+
+std::string InputReader::readWord() {
+    skipBlanks(false);
+    size_t begin = pos;
+    while (pos < size && !isBlank(data[pos])) {
+        pos++;
+    }
+    return std::string(data + begin, pos - begin);
+}
+
+std::string InputReader::peekWord() {
+    size_t start = pos;
+    std::string word = readWord();
+    pos = start;
+    return word;
+}
+
+long long InputReader::readInt() {
+    skipBlanks(false);
+    long long value = 0;
+    if (!readIntOnLine(value)) {
+        std::cerr << "Unexpected end of input, expected an integer" << std::endl;
+        exit(1);
+    }
+    return value;
+}
+
+bool InputReader::readIntOnLine(long long &value) {
+    skipBlanks(true);
+    if (pos >= size || data[pos] == '\n') {
+        return false;
+    }
+    size_t begin = pos;
+    bool negative = data[pos] == '-';
+    if (negative) {
+        pos++;
+    }
+    size_t digits = pos;
+    value = 0;
+    while (pos < size && data[pos] >= '0' && data[pos] <= '9') {
+        value = value * 10 + (data[pos] - '0');
+        pos++;
+    }
+    // a malformed token would otherwise turn into a valid looking 0
+    if (pos == digits || (pos < size && !isBlank(data[pos]))) {
+        while (pos < size && !isBlank(data[pos])) {
+            pos++;
+        }
+        std::cerr << "Expected an integer, got \"" << std::string(data + begin, pos - begin) << "\"" << std::endl;
+        exit(1);
+    }
+    if (negative) {
+        value = -value;
+    }
+    return true;
+}
+
+void InputReader::skipLine() {
+    while (pos < size && data[pos] != '\n') {
+        pos++;
+    }
+}
+
+bool InputReader::atEnd() {
+    skipBlanks(false);
+    return pos >= size;
+}
+
+void InputReader::skipBlanks(bool stopAtNewline) {
+    while (pos < size) {
+        if (data[pos] == '\n') {
+            if (stopAtNewline) {
+                return;
+            }
+            pos++;
+        } else if (isBlank(data[pos])) {
+            pos++;
+        } else if (!stopAtNewline && atCommentLine()) {
+            skipLine();
+        } else {
+            return;
+        }
+    }
+}
+
+bool InputReader::atCommentLine() const {
+    // a lone "c" as the first token of a line
+    if (data[pos] != 'c' || (pos + 1 < size && !isBlank(data[pos + 1]))) {
+        return false;
+    }
+    size_t back = pos;
+    while (back > 0 && (data[back - 1] == ' ' || data[back - 1] == '\t')) {
+        back--;
+    }
+    return back == 0 || data[back - 1] == '\n';
+}
@@ -0,0 +1,75 @@
+#ifndef PACE2018_INPUT_READER_H
+#define PACE2018_INPUT_READER_H
+
+#include <cstddef>
+#include <istream>
+#include <string>
+#include <vector>
+
+/**
+ * Buffered tokenizer for the PACE input sections
+ *
+ * The whole input is taken at once, a file is memory mapped and a stream descriptor is read in
+ * large blocks. Tokens are whitespace separated, integers are parsed by hand, and lines starting
+ * with a "c" token are skipped as comments wherever they appear.
+ */
+class InputReader {
+public:
+    /**
+     * Reads everything available on the file descriptor, 0 for the standard input
+     */
+    explicit InputReader(int fd);
+
+    /**
+     * Maps the file at the given path, exits if it cannot be opened
+     */
+    explicit InputReader(const std::string &path);
+
+    /**
+     * Takes lines from the stream until the given number of END lines was read, leaving the
+     * rest of the stream untouched for other readers
+     */
+    InputReader(std::istream &input, unsigned sectionCount);
+
+    ~InputReader();
+
+    InputReader(const InputReader&) = delete;
+    InputReader& operator=(const InputReader&) = delete;
+
+    std::string readWord();
+
+    /**
+     * Reads the next integer, exits if the input ends or the token is not a number
+     */
+    long long readInt();
+
+    /**
+     * Returns the next word without consuming it, empty at the end of the input
+     */
+    std::string peekWord();
+
+    /**
+     * Reads an integer from the current line, returns false once the line has ended. Exits if the
+     * token is not a number.
+     */
+    bool readIntOnLine(long long &value);
+
+    void skipLine();
+    bool atEnd();
+
+private:
+    void skipBlanks(bool stopAtNewline);
+    bool atCommentLine() const;
+
+    static bool isBlank(char c) {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+    }
+
+    const char *data;
+    size_t size, pos;
+    std::vector<char> storage;
+    void *mapped;
+};
+
+
+#endif //PACE2018_INPUT_READER_H
@@ -0,0 +1,131 @@
+#include "min_plus.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define PACE2018_X86_KERNELS
+#endif
+
+namespace {
+    void minPlusScalar(unsigned *target, const unsigned *left, const unsigned *right,
+                       unsigned from, unsigned size) {
+        for (unsigned i = from; i < size; i++) {
+            unsigned candidate = left[i] + right[i];
+            target[i] = candidate < target[i] ? candidate : target[i];
+        }
+    }
+
+    void argminScalar(const unsigned *target, const unsigned *left, const unsigned *right,
+                      unsigned from, unsigned size, unsigned split, unsigned *splits) {
+        for (unsigned i = from; i < size; i++) {
+            if (splits[i] == 0 && left[i] + right[i] == target[i]) {
+                splits[i] = split;
+            }
+        }
+    }
+
+#ifdef PACE2018_X86_KERNELS
+    __attribute__((target("avx2")))
+    void minPlusAVX2(unsigned *target, const unsigned *left, const unsigned *right, unsigned size) {
+        unsigned i = 0;
+        for (; i + 8 <= size; i += 8) {
+            __m256i sum = _mm256_add_epi32(_mm256_loadu_si256((const __m256i*)(left + i)),
+                                           _mm256_loadu_si256((const __m256i*)(right + i)));
+            __m256i curr = _mm256_loadu_si256((const __m256i*)(target + i));
+            _mm256_storeu_si256((__m256i*)(target + i), _mm256_min_epu32(sum, curr));
+        }
+        minPlusScalar(target, left, right, i, size);
+    }
+
+    __attribute__((target("avx2")))
+    void argminAVX2(const unsigned *target, const unsigned *left, const unsigned *right,
+                    unsigned size, unsigned split, unsigned *splits) {
+        __m256i zero = _mm256_setzero_si256(), splitVec = _mm256_set1_epi32((int)split);
+        unsigned i = 0;
+        for (; i + 8 <= size; i += 8) {
+            __m256i sum = _mm256_add_epi32(_mm256_loadu_si256((const __m256i*)(left + i)),
+                                           _mm256_loadu_si256((const __m256i*)(right + i)));
+            __m256i curr = _mm256_loadu_si256((const __m256i*)(splits + i));
+            __m256i hit = _mm256_and_si256(
+                    _mm256_cmpeq_epi32(sum, _mm256_loadu_si256((const __m256i*)(target + i))),
+                    _mm256_cmpeq_epi32(curr, zero));
+            _mm256_storeu_si256((__m256i*)(splits + i), _mm256_blendv_epi8(curr, splitVec, hit));
+        }
+        argminScalar(target, left, right, i, size, split, splits);
+    }
+
+    __attribute__((target("sse4.1")))
+    void minPlusSSE41(unsigned *target, const unsigned *left, const unsigned *right, unsigned size) {
+        unsigned i = 0;
+        for (; i + 4 <= size; i += 4) {
+            __m128i sum = _mm_add_epi32(_mm_loadu_si128((const __m128i*)(left + i)),
+                                        _mm_loadu_si128((const __m128i*)(right + i)));
+            __m128i curr = _mm_loadu_si128((const __m128i*)(target + i));
+            _mm_storeu_si128((__m128i*)(target + i), _mm_min_epu32(sum, curr));
+        }
+        minPlusScalar(target, left, right, i, size);
+    }
+
+    __attribute__((target("sse4.1")))
+    void argminSSE41(const unsigned *target, const unsigned *left, const unsigned *right,
+                     unsigned size, unsigned split, unsigned *splits) {
+        __m128i zero = _mm_setzero_si128(), splitVec = _mm_set1_epi32((int)split);
+        unsigned i = 0;
+        for (; i + 4 <= size; i += 4) {
+            __m128i sum = _mm_add_epi32(_mm_loadu_si128((const __m128i*)(left + i)),
+                                        _mm_loadu_si128((const __m128i*)(right + i)));
+            __m128i curr = _mm_loadu_si128((const __m128i*)(splits + i));
+            __m128i hit = _mm_and_si128(
+                    _mm_cmpeq_epi32(sum, _mm_loadu_si128((const __m128i*)(target + i))),
+                    _mm_cmpeq_epi32(curr, zero));
+            _mm_storeu_si128((__m128i*)(splits + i), _mm_blendv_epi8(curr, splitVec, hit));
+        }
+        argminScalar(target, left, right, i, size, split, splits);
+    }
+#endif
+
+    enum KernelLevel {SCALAR, SSE41, AVX2};
+
+    KernelLevel detectKernelLevel() {
+#ifdef PACE2018_X86_KERNELS
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            return AVX2;
+        }
+        if (__builtin_cpu_supports("sse4.1")) {
+            return SSE41;
+        }
+#endif
+        return SCALAR;
+    }
+
+    const KernelLevel kernelLevel = detectKernelLevel();
+}
+
+void minPlus(unsigned *target, const unsigned *left, const unsigned *right, unsigned size) {
+#ifdef PACE2018_X86_KERNELS
+    if (kernelLevel == AVX2) {
+        minPlusAVX2(target, left, right, size);
+        return;
+    }
+    if (kernelLevel == SSE41) {
+        minPlusSSE41(target, left, right, size);
+        return;
+    }
+#endif
+    minPlusScalar(target, left, right, 0, size);
+}
+
+void minPlusArgmin(const unsigned *target, const unsigned *left, const unsigned *right,
+                   unsigned size, unsigned split, unsigned *splits) {
+#ifdef PACE2018_X86_KERNELS
+    if (kernelLevel == AVX2) {
+        argminAVX2(target, left, right, size, split, splits);
+        return;
+    }
+    if (kernelLevel == SSE41) {
+        argminSSE41(target, left, right, size, split, splits);
+        return;
+    }
+#endif
+    argminScalar(target, left, right, 0, size, split, splits);
+}
@@ -0,0 +1,22 @@
+#ifndef PACE2018_MIN_PLUS_H
+#define PACE2018_MIN_PLUS_H
+
+/**
+ * Element-wise min-plus kernels over unsigned arrays, used for merging subsets in Dreyfus-Wagner
+ *
+ * The implementation is picked at runtime: AVX2, SSE4.1, or a scalar loop. Sums of two values
+ * are expected to fit into 32 bits.
+ */
+
+/**
+ * target[i] = min(target[i], left[i] + right[i])
+ */
+void minPlus(unsigned *target, const unsigned *left, const unsigned *right, unsigned size);
+
+/**
+ * splits[i] = split, for all i where splits[i] is still 0 and left[i] + right[i] == target[i]
+ */
+void minPlusArgmin(const unsigned *target, const unsigned *left, const unsigned *right,
+                   unsigned size, unsigned split, unsigned *splits);
+
+#endif //PACE2018_MIN_PLUS_H
@@ -0,0 +1,200 @@
+#include "partition_catalogue.h"
+
+#include <algorithm>
+#include <functional>
+
+#include "utility/partition_mergers.h"
+
+const PartitionCatalogue &PartitionCatalogue::get() {
+    static const PartitionCatalogue catalogue;
+    return catalogue;
+}
+
+PartitionCatalogue::PartitionCatalogue() : levels(MAX_SIZE + 1) {
+    for (unsigned size = 0; size <= MAX_SIZE; size++) {
+        generate(size);
+    }
+    for (unsigned size = 0; size <= MAX_SIZE; size++) {
+        generateTransitions(size);
+    }
+}
+
+unsigned PartitionCatalogue::count(unsigned size) const {
+    return (unsigned)levels[size].partitions.size();
+}
+
+uint64_t PartitionCatalogue::partitionAt(unsigned size, unsigned index) const {
+    return levels[size].partitions[index];
+}
+
+unsigned PartitionCatalogue::indexOf(unsigned size, uint64_t partition) const {
+    return (unsigned)rankPartition(partition, size);
+}
+
+unsigned PartitionCatalogue::blockCount(unsigned size, unsigned index) const {
+    return levels[size].blocks[index];
+}
+
+bool PartitionCatalogue::isSingleton(unsigned size, unsigned at, unsigned index) const {
+    uint64_t partition = levels[size].partitions[index];
+    unsigned block = getComponentAt(partition, at);
+    for (unsigned i = 0; i < size; i++) {
+        if (i != at && (unsigned)getComponentAt(partition, i) == block) {
+            return false;
+        }
+    }
+    return true;
+}
+
+unsigned PartitionCatalogue::erased(unsigned size, unsigned at, unsigned index) const {
+    return levels[size].erased[at * count(size) + index];
+}
+
+unsigned PartitionCatalogue::inserted(unsigned size, unsigned at, unsigned block, unsigned index) const {
+    return levels[size].inserted[(at * (size + 1) + block) * count(size) + index];
+}
+
+unsigned PartitionCatalogue::merged(unsigned size, unsigned first, unsigned second, unsigned index) const {
+    return levels[size].merged[(first * size + second) * count(size) + index];
+}
+
+std::pair<const uint16_t*, const uint16_t*> PartitionCatalogue::splits(unsigned size, unsigned first, unsigned second,
+                                                                      unsigned index) const {
+    const Level &level = levels[size];
+    unsigned key = (first * size + second) * count(size) + index;
+    return {level.splits.data() + level.splitOffsets[key], level.splits.data() + level.splitOffsets[key + 1]};
+}
+
+std::pair<const uint16_t*, const uint16_t*> PartitionCatalogue::refinements(unsigned size, unsigned index) const {
+    const Level &level = levels[size];
+    return {level.refinements.data() + level.refinementOffsets[index],
+            level.refinements.data() + level.refinementOffsets[index + 1]};
+}
+
+unsigned PartitionCatalogue::joined(unsigned size, unsigned first, unsigned second) const {
+    return levels[size].joined[first * count(size) + second];
+}
+
+void PartitionCatalogue::generate(unsigned size) {
+    Level &level = levels[size];
+
+    // restricted growth strings, trying smaller blocks first gives the lexicographic order
+    std::function<void(unsigned, unsigned, uint64_t)> extend = [&](unsigned at, unsigned blocks, uint64_t partition) {
+        if (at == size) {
+            level.partitions.push_back(partition);
+            level.blocks.push_back((uint8_t)blocks);
+            return;
+        }
+        for (unsigned block = 0; block <= blocks; block++) {
+            uint64_t next = partition;
+            setComponentAt(next, at, (unsigned char)block);
+            extend(at + 1, block == blocks ? blocks + 1 : blocks, next);
+        }
+    };
+    extend(0, 0, 0);
+}
+
+void PartitionCatalogue::generateTransitions(unsigned size) {
+    Level &level = levels[size];
+    unsigned cnt = count(size), all = lowBits(size);
+
+    if (size > 0) {
+        level.erased.resize(size * cnt);
+        for (unsigned at = 0; at < size; at++) {
+            for (unsigned i = 0; i < cnt; i++) {
+                uint64_t shorter = canonizePartition(eraseComponentAt(level.partitions[i], at, size),
+                                                     lowBits(size - 1), size - 1);
+                level.erased[at * cnt + i] = (uint16_t)indexOf(size - 1, shorter);
+            }
+        }
+    }
+
+    if (size < MAX_SIZE) {
+        level.inserted.resize((size + 1) * (size + 1) * cnt, NONE);
+        for (unsigned at = 0; at <= size; at++) {
+            for (unsigned i = 0; i < cnt; i++) {
+                for (unsigned block = 0; block <= level.blocks[i]; block++) {
+                    uint64_t longer = canonizePartition(insertComponentAt(level.partitions[i], at, block, size),
+                                                        lowBits(size + 1), size + 1);
+                    level.inserted[(at * (size + 1) + block) * cnt + i] = (uint16_t)indexOf(size + 1, longer);
+                }
+            }
+        }
+    }
+
+    // merges, and their inverse for the pairs in separate blocks
+    level.merged.resize(size * size * cnt);
+    level.splitOffsets.assign(size * size * cnt + 1, 0);
+    for (unsigned first = 0; first < size; first++) {
+        for (unsigned second = 0; second < size; second++) {
+            for (unsigned i = 0; i < cnt; i++) {
+                uint64_t partition = level.partitions[i];
+                unsigned from = getComponentAt(partition, second), to = getComponentAt(partition, first);
+                unsigned result = indexOf(size, canonizePartition(relabelComponent(partition, from, to, all, size),
+                                                                  all, size));
+                level.merged[(first * size + second) * cnt + i] = (uint16_t)result;
+                if (from != to) {
+                    level.splitOffsets[(first * size + second) * cnt + result + 1]++;
+                }
+            }
+        }
+    }
+    for (unsigned key = 0; key < size * size * cnt; key++) {
+        level.splitOffsets[key + 1] += level.splitOffsets[key];
+    }
+    level.splits.resize(level.splitOffsets.back());
+    std::vector<unsigned> fill(level.splitOffsets.begin(), level.splitOffsets.end() - 1);
+    for (unsigned first = 0; first < size; first++) {
+        for (unsigned second = 0; second < size; second++) {
+            for (unsigned i = 0; i < cnt; i++) {
+                unsigned result = level.merged[(first * size + second) * cnt + i];
+                if (result != i) {
+                    level.splits[fill[(first * size + second) * cnt + result]++] = (uint16_t)i;
+                }
+            }
+        }
+    }
+
+    level.refinementOffsets.push_back(0);
+    for (unsigned i = 0; i < cnt; i++) {
+        generateRefinements(size, i);
+        level.refinementOffsets.push_back((unsigned)level.refinements.size());
+    }
+
+    if (size <= MAX_JOIN_SIZE) {
+        level.joined.resize(cnt * cnt);
+        UnionFindMerger merger(size, all);
+        for (unsigned first = 0; first < cnt; first++) {
+            for (unsigned second = 0; second < cnt; second++) {
+                uint64_t result = merger.join(level.partitions[first], level.partitions[second]);
+                level.joined[first * cnt + second] = result == PARTITION_INVALID ? NONE
+                                                                                 : (uint16_t)indexOf(size, result);
+            }
+        }
+    }
+}
+
+void PartitionCatalogue::generateRefinements(unsigned size, unsigned index) {
+    Level &level = levels[size];
+    uint64_t coarse = level.partitions[index];
+
+    // every element joins an earlier finer block inside its own coarse block, or opens a new one
+    unsigned char parentOf[MAX_SIZE];
+    std::function<void(unsigned, unsigned, uint64_t)> extend = [&](unsigned at, unsigned blocks, uint64_t partition) {
+        if (at == size) {
+            level.refinements.push_back((uint16_t)indexOf(size, partition));
+            return;
+        }
+        auto parent = (unsigned char)getComponentAt(coarse, at);
+        for (unsigned block = 0; block <= blocks; block++) {
+            if (block < blocks && parentOf[block] != parent) {
+                continue;
+            }
+            uint64_t next = partition;
+            setComponentAt(next, at, (unsigned char)block);
+            parentOf[block] = parent;
+            extend(at + 1, block == blocks ? blocks + 1 : blocks, next);
+        }
+    };
+    extend(0, 0, 0);
+}
@@ -0,0 +1,98 @@
+#ifndef PACE2018_PARTITION_CATALOGUE_H
+#define PACE2018_PARTITION_CATALOGUE_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "utility/helpers.h"
+
+/**
+ * Every canonical partition of up to MAX_SIZE elements with a dense index, and the DP transitions between them
+ *
+ * Partitions are stored compressed, the i-th element of a subset takes the i-th nibble, see compressPartition.
+ * Indices follow the lexicographic order of the restricted growth strings, the first element being the most
+ * significant. The catalogue is built once on first use and only read afterwards, so it is shared by all threads.
+ */
+class PartitionCatalogue {
+public:
+    static const unsigned MAX_SIZE = 8;
+    // the join table is quadratic in the partition count, Bell(8)^2 would take 34MB
+    static const unsigned MAX_JOIN_SIZE = 7;
+    static constexpr uint16_t NONE = 0xFFFF;
+
+    static const PartitionCatalogue &get();
+
+    /**
+     * Number of partitions of the given size, the Bell number
+     */
+    unsigned count(unsigned size) const;
+
+    uint64_t partitionAt(unsigned size, unsigned index) const;
+
+    /**
+     * Index of a canonical compressed partition, the same as rankPartition
+     */
+    unsigned indexOf(unsigned size, uint64_t partition) const;
+
+    unsigned blockCount(unsigned size, unsigned index) const;
+
+    /**
+     * Whether the element at the position has a block of its own
+     */
+    bool isSingleton(unsigned size, unsigned at, unsigned index) const;
+
+    /**
+     * Partition of size - 1 elements after removing the one at the position
+     */
+    unsigned erased(unsigned size, unsigned at, unsigned index) const;
+
+    /**
+     * Partition of size + 1 elements with a new element at the position joining the given block,
+     * block count opens a new one
+     */
+    unsigned inserted(unsigned size, unsigned at, unsigned block, unsigned index) const;
+
+    /**
+     * Partition with the blocks of the elements at both positions merged
+     */
+    unsigned merged(unsigned size, unsigned first, unsigned second, unsigned index) const;
+
+    /**
+     * All partitions with the elements at both positions in separate blocks which give the partition when merged
+     */
+    std::pair<const uint16_t*, const uint16_t*> splits(unsigned size, unsigned first, unsigned second,
+                                                      unsigned index) const;
+
+    /**
+     * All partitions refining the partition, itself included
+     */
+    std::pair<const uint16_t*, const uint16_t*> refinements(unsigned size, unsigned index) const;
+
+    /**
+     * Finest partition coarser than both, NONE if merging their blocks closes a cycle
+     */
+    unsigned joined(unsigned size, unsigned first, unsigned second) const;
+
+private:
+    PartitionCatalogue();
+
+    void generate(unsigned size);
+    void generateRefinements(unsigned size, unsigned index);
+    void generateTransitions(unsigned size);
+
+    struct Level {
+        std::vector<uint64_t> partitions;
+        std::vector<uint8_t> blocks;
+
+        std::vector<uint16_t> erased, inserted, merged, joined;
+        // flat lists, offsets into them per (first, second, index) and per index
+        std::vector<uint16_t> splits, refinements;
+        std::vector<unsigned> splitOffsets, refinementOffsets;
+    };
+
+    std::vector<Level> levels;
+};
+
+
+#endif //PACE2018_PARTITION_CATALOGUE_H
@@ -84,48 +84,5 @@ bool BinaryDFSMerger::dfs(char color, unsigned idx) {
 }
 
 uint64_t UnionFindMerger::merge(uint64_t part1, uint64_t part2) {
-    unionFind.setupPairs();
-    std::fill(repre1.begin(), repre1.end(), -1);
-    std::fill(repre2.begin(), repre2.end(), -1);
-    for (unsigned char i = 0; i < size; i++) {
-        if (!isInSubset(i, subset)) {
-            continue;
-        }
-
-        int comp1 = getComponentAt(part1, i),
-            comp2 = getComponentAt(part2, i);
-
-        if (repre1[comp1] == -1) {
-            repre1[comp1] = i;
-        } else {
-            if (!unionFind.join(i, repre1[comp1])) {
-                // cyclic merge
-                return PARTITION_INVALID;
-            }
-        }
-        if (repre2[comp2] == -1) {
-            repre2[comp2] = i;
-        } else {
-            if (!unionFind.join((char)size + i, (char)size + repre2[comp2])) {
-                // cyclic merge
-                return PARTITION_INVALID;
-            }
-        }
-    }
-
-    uint64_t result = 0, ctr = 0;
-    std::fill(mapping.begin(), mapping.end(), -1);
-    for (unsigned i = 0; i < size; i++) {
-        if (!isInSubset(i, subset)) {
-            continue;
-        }
-
-        int comp = unionFind.find((char)i);
-        if (mapping[comp] == -1) {
-            mapping[comp] = (char)ctr++;
-        }
-        result |= (uint64_t)mapping[comp] << (i << 2ull);
-    }
-
-    return result;
+    return join(part1, part2);
 }
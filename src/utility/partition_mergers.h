@@ -77,9 +77,64 @@ public:
 
     uint64_t merge(uint64_t part1, uint64_t part2) override;
 
+    /**
+     * Merge of partitions in any encoding, returns the all-ones key of the encoding for cyclic merges
+     */
+    template <typename Partition>
+    Partition join(const Partition &part1, const Partition &part2);
+
 private:
     std::vector<char> repre1, repre2, mapping;
     UnionFind unionFind;
 };
 
+template <typename Partition>
+Partition UnionFindMerger::join(const Partition &part1, const Partition &part2) {
+    unionFind.setupPairs();
+    std::fill(repre1.begin(), repre1.end(), -1);
+    std::fill(repre2.begin(), repre2.end(), -1);
+    for (unsigned char i = 0; i < size; i++) {
+        if (!isInSubset(i, subset)) {
+            continue;
+        }
+
+        int comp1 = getComponentAt(part1, i),
+            comp2 = getComponentAt(part2, i);
+
+        if (repre1[comp1] == -1) {
+            repre1[comp1] = i;
+        } else {
+            if (!unionFind.join(i, repre1[comp1])) {
+                // cyclic merge
+                return PartitionTraits<Partition>::empty();
+            }
+        }
+        if (repre2[comp2] == -1) {
+            repre2[comp2] = i;
+        } else {
+            if (!unionFind.join((char)size + i, (char)size + repre2[comp2])) {
+                // cyclic merge
+                return PartitionTraits<Partition>::empty();
+            }
+        }
+    }
+
+    Partition result{};
+    char ctr = 0;
+    std::fill(mapping.begin(), mapping.end(), -1);
+    for (unsigned i = 0; i < size; i++) {
+        if (!isInSubset(i, subset)) {
+            continue;
+        }
+
+        int comp = unionFind.find((char)i);
+        if (mapping[comp] == -1) {
+            mapping[comp] = ctr++;
+        }
+        setComponentAt(result, i, (unsigned char)mapping[comp]);
+    }
+
+    return result;
+}
+
 #endif //PACE2018_PARTITION_MERGERS_H
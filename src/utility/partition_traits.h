@@ -0,0 +1,103 @@
+#ifndef PACE2018_PARTITION_TRAITS_H
+#define PACE2018_PARTITION_TRAITS_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+__extension__ typedef unsigned __int128 uint128_t;
+
+/**
+ * Packed partition encodings, every vertex of a bag keeps the index of its component in a fixed width field
+ *
+ * Each encoding provides access to the fields, a hash for the state tables and the all-ones key which never
+ * is a canonical partition. Solvers are instantiated once per encoding, the narrowest one fitting the bag
+ * is the fastest.
+ */
+template <typename Partition>
+struct PartitionTraits;
+
+/**
+ * 4 bits per vertex, up to 16 vertices
+ */
+template <>
+struct PartitionTraits<uint64_t> {
+    static const unsigned MAX_SIZE = 16;
+
+    static unsigned get(const uint64_t &partition, unsigned at) {
+        return (unsigned)((partition >> (at << 2u)) & 0xFu);
+    }
+
+    static void set(uint64_t &partition, unsigned at, unsigned value) {
+        partition &= ~(0xFull << (at << 2u));
+        partition |= (uint64_t)value << (at << 2u);
+    }
+
+    static uint64_t hash(const uint64_t &partition) {
+        return partition;
+    }
+
+    static uint64_t empty() {
+        return 0xFFFFFFFFFFFFFFFF;
+    }
+};
+
+/**
+ * 5 bits per vertex, up to 25 vertices
+ */
+template <>
+struct PartitionTraits<uint128_t> {
+    static const unsigned MAX_SIZE = 25;
+
+    static unsigned get(const uint128_t &partition, unsigned at) {
+        return (unsigned)(partition >> (at * 5u)) & 0x1Fu;
+    }
+
+    static void set(uint128_t &partition, unsigned at, unsigned value) {
+        partition &= ~((uint128_t)0x1F << (at * 5u));
+        partition |= (uint128_t)value << (at * 5u);
+    }
+
+    static uint64_t hash(const uint128_t &partition) {
+        return (uint64_t)partition ^ ((uint64_t)(partition >> 64u) * 0xC2B2AE3D27D4EB4Full);
+    }
+
+    static uint128_t empty() {
+        return ~(uint128_t)0;
+    }
+};
+
+/**
+ * A byte per vertex, 8 vertices per word
+ */
+template <size_t N>
+struct PartitionTraits<std::array<uint64_t, N>> {
+    static const unsigned MAX_SIZE = 8 * N;
+
+    static unsigned get(const std::array<uint64_t, N> &partition, unsigned at) {
+        return (unsigned)(partition[at >> 3u] >> ((at & 7u) << 3u)) & 0xFFu;
+    }
+
+    static void set(std::array<uint64_t, N> &partition, unsigned at, unsigned value) {
+        uint64_t &word = partition[at >> 3u];
+        word &= ~(0xFFull << ((at & 7u) << 3u));
+        word |= (uint64_t)value << ((at & 7u) << 3u);
+    }
+
+    static uint64_t hash(const std::array<uint64_t, N> &partition) {
+        uint64_t result = 0;
+        for (auto word : partition) {
+            result = (result ^ word) * 0xC2B2AE3D27D4EB4Full;
+        }
+        return result;
+    }
+
+    static std::array<uint64_t, N> empty() {
+        std::array<uint64_t, N> result;
+        result.fill(0xFFFFFFFFFFFFFFFF);
+        return result;
+    }
+};
+
+
+#endif //PACE2018_PARTITION_TRAITS_H
@@ -0,0 +1,101 @@
+#include "shortest_paths.h"
+
+#include <algorithm>
+#include <functional>
+
+RadixHeap::RadixHeap() : last(0), count(0) {}
+
+void RadixHeap::push(unsigned key, unsigned node) {
+    buckets[bucketOf(key, last)].push_back({key, node});
+    count++;
+}
+
+std::pair<unsigned, unsigned> RadixHeap::pop() {
+    if (buckets[0].empty()) {
+        // move the bucket holding the minimum down, relative to the new minimum
+        unsigned idx = 1;
+        while (buckets[idx].empty()) {
+            idx++;
+        }
+        unsigned minKey = buckets[idx][0].first;
+        for (auto &item : buckets[idx]) {
+            minKey = std::min(minKey, item.first);
+        }
+        last = minKey;
+        for (auto &item : buckets[idx]) {
+            buckets[bucketOf(item.first, last)].push_back(item);
+        }
+        buckets[idx].clear();
+    }
+    std::pair<unsigned, unsigned> top = buckets[0].back();
+    buckets[0].pop_back();
+    count--;
+    return top;
+}
+
+void RadixHeap::clear() {
+    for (auto &bucket : buckets) {
+        bucket.clear();
+    }
+    last = 0;
+    count = 0;
+}
+
+void ShortestPaths::relax(const Graph &graph, unsigned *dist, int *parent, unsigned infinity) {
+    if (queue == Queue::RADIX_HEAP) {
+        radix.clear();
+        run(graph, dist, parent, infinity,
+            [this](unsigned key, unsigned node) { radix.push(key, node); },
+            [this]() { return radix.pop(); },
+            [this]() { return radix.empty(); });
+        return;
+    }
+
+    auto cmp = std::greater<std::pair<unsigned, unsigned>>();
+    binary.clear();
+    run(graph, dist, parent, infinity,
+        [this, &cmp](unsigned key, unsigned node) {
+            binary.push_back({key, node});
+            std::push_heap(binary.begin(), binary.end(), cmp);
+        },
+        [this, &cmp]() {
+            std::pop_heap(binary.begin(), binary.end(), cmp);
+            std::pair<unsigned, unsigned> top = binary.back();
+            binary.pop_back();
+            return top;
+        },
+        [this]() { return binary.empty(); });
+}
+
+template <typename PushFn, typename PopFn, typename EmptyFn>
+void ShortestPaths::run(const Graph &graph, unsigned *dist, int *parent, unsigned infinity,
+                        PushFn push, PopFn pop, EmptyFn empty) {
+    auto n = (unsigned)graph.getNodeCount();
+    closed.assign(n, 0);
+    for (unsigned i = 0; i < n; i++) {
+        if (dist[i] < infinity && !graph.isNodeErased(i)) {
+            push(dist[i], i);
+        }
+    }
+
+    while (!empty()) {
+        std::pair<unsigned, unsigned> curr = pop();
+        if (closed[curr.second]) {
+            continue;
+        }
+        closed[curr.second] = 1;
+        for (unsigned arc = graph.arcBegin(curr.second); arc < graph.arcEnd(curr.second); arc++) {
+            int next = graph.arcTarget(arc);
+            if (closed[next]) {
+                continue;
+            }
+            if (dist[next] > curr.first + graph.arcWeight(arc)) {
+                dist[next] = curr.first + graph.arcWeight(arc);
+                if (parent) {
+                    parent[next] = curr.second;
+                }
+                push(dist[next], next);
+            }
+        }
+    }
+}
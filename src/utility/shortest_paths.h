@@ -0,0 +1,70 @@
+#ifndef PACE2018_SHORTEST_PATHS_H
+#define PACE2018_SHORTEST_PATHS_H
+
+#include <utility>
+#include <vector>
+
+#include "structures/graph.h"
+
+/**
+ * Monotone priority queue of (key, node) pairs, popped keys never decrease
+ *
+ * Pairs are kept in 33 buckets by the highest bit in which their key differs from the last
+ * popped key. Bucket storage is kept between runs, so reuse does not allocate.
+ */
+class RadixHeap {
+public:
+    RadixHeap();
+
+    void push(unsigned key, unsigned node);
+    std::pair<unsigned, unsigned> pop();
+
+    bool empty() const {
+        return count == 0;
+    }
+
+    void clear();
+
+private:
+    static unsigned bucketOf(unsigned key, unsigned last) {
+        return key == last ? 0 : 32 - (unsigned)__builtin_clz(key ^ last);
+    }
+
+    std::vector<std::pair<unsigned, unsigned>> buckets[33];
+    unsigned last, count;
+};
+
+/**
+ * Reusable multi-source Dijkstra engine
+ *
+ * Distances are relaxed in place from their current values, so every node with a finite value is
+ * a source. The queue implementation can be chosen, the binary heap is kept for comparison.
+ */
+class ShortestPaths {
+public:
+    enum class Queue {
+        RADIX_HEAP,
+        BINARY_HEAP
+    };
+
+    explicit ShortestPaths(Queue queue = Queue::RADIX_HEAP) : queue(queue) {}
+
+    /**
+     * Relaxes dist over the graph, values of at least infinity are treated as unreachable.
+     * If parent is given, every improved node gets its predecessor written there.
+     */
+    void relax(const Graph &graph, unsigned *dist, int *parent, unsigned infinity);
+
+private:
+    template <typename PushFn, typename PopFn, typename EmptyFn>
+    void run(const Graph &graph, unsigned *dist, int *parent, unsigned infinity,
+             PushFn push, PopFn pop, EmptyFn empty);
+
+    Queue queue;
+    RadixHeap radix;
+    std::vector<std::pair<unsigned, unsigned>> binary;
+    std::vector<char> closed;
+};
+
+
+#endif //PACE2018_SHORTEST_PATHS_H
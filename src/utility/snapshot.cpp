@@ -0,0 +1,96 @@
+#include "snapshot.h"
+
+#include <algorithm>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+SnapshotWriter::SnapshotWriter(const std::string &path) : written(0) {
+    file = fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        std::cerr << "Cannot create snapshot " << path << std::endl;
+        exit(1);
+    }
+    writeRaw(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    write(SNAPSHOT_VERSION);
+    pad();
+}
+
+SnapshotWriter::~SnapshotWriter() {
+    fclose(file);
+}
+
+void SnapshotWriter::writeArray(const std::vector<bool> &values) {
+    writeArray(std::vector<uint8_t>(values.begin(), values.end()));
+}
+
+void SnapshotWriter::writeRaw(const void *data, size_t size) {
+    if (size != 0 && fwrite(data, 1, size, file) != size) {
+        std::cerr << "Cannot write snapshot" << std::endl;
+        exit(1);
+    }
+    written += size;
+}
+
+void SnapshotWriter::pad() {
+    const char zeros[8] = {};
+    writeRaw(zeros, (8 - written % 8) % 8);
+}
+
+SnapshotReader::SnapshotReader(const std::string &path) : data(nullptr), size(0), pos(0), mapped(nullptr) {
+    int fd = open(path.c_str(), O_RDONLY);
+    struct stat info = {};
+    if (fd == -1 || fstat(fd, &info) != 0 || info.st_size == 0) {
+        std::cerr << "Cannot open snapshot " << path << std::endl;
+        exit(1);
+    }
+    size = (size_t)info.st_size;
+    mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        std::cerr << "Cannot map snapshot " << path << std::endl;
+        exit(1);
+    }
+    data = static_cast<const char*>(mapped);
+
+    char magic[sizeof(SNAPSHOT_MAGIC)];
+    readRaw(magic, sizeof(magic));
+    auto version = read<uint32_t>();
+    if (memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic)) != 0 || version != SNAPSHOT_VERSION) {
+        std::cerr << "Snapshot " << path << " is not of version " << SNAPSHOT_VERSION << std::endl;
+        exit(1);
+    }
+    skipPadding();
+}
+
+SnapshotReader::~SnapshotReader() {
+    munmap(mapped, size);
+}
+
+void SnapshotReader::readArray(std::vector<bool> &values) {
+    std::vector<uint8_t> bytes;
+    readArray(bytes);
+    values.assign(bytes.begin(), bytes.end());
+}
+
+void SnapshotReader::readRaw(void *target, size_t count) {
+    if (count > size - pos) {
+        truncated();
+    }
+    if (count != 0) {
+        memcpy(target, data + pos, count);
+    }
+    pos += count;
+}
+
+void SnapshotReader::skipPadding() {
+    // a truncated file may end inside the padding, later reads then fail cleanly
+    pos = std::min(size, pos + (8 - pos % 8) % 8);
+}
+
+void SnapshotReader::truncated() {
+    std::cerr << "Snapshot is truncated" << std::endl;
+    exit(1);
+}
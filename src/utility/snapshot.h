@@ -0,0 +1,99 @@
+#ifndef PACE2018_SNAPSHOT_H
+#define PACE2018_SNAPSHOT_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/**
+ * Binary snapshot of a preprocessed instance
+ *
+ * The file starts with a magic string and a format version, followed by plain values and flat
+ * arrays. Every array is its element count followed by the raw elements, padded to 8 bytes, so
+ * the whole file can be mapped and copied out without any parsing.
+ */
+const char SNAPSHOT_MAGIC[8] = {'P', 'A', 'C', 'E', 'S', 'N', 'A', 'P'};
+const uint32_t SNAPSHOT_VERSION = 2;
+
+class SnapshotWriter {
+public:
+    /**
+     * Creates the file and writes the header, exits if the file cannot be created
+     */
+    explicit SnapshotWriter(const std::string &path);
+    ~SnapshotWriter();
+
+    SnapshotWriter(const SnapshotWriter&) = delete;
+    SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+    template <typename T>
+    void write(const T &value) {
+        static_assert(std::is_trivially_copy_constructible<T>::value, "snapshot values must be plain data");
+        writeRaw(&value, sizeof(T));
+    }
+
+    template <typename T>
+    void writeArray(const std::vector<T> &values) {
+        static_assert(std::is_trivially_copy_constructible<T>::value, "snapshot values must be plain data");
+        write((uint64_t)values.size());
+        writeRaw(values.data(), values.size() * sizeof(T));
+        pad();
+    }
+
+    void writeArray(const std::vector<bool> &values);
+
+private:
+    void writeRaw(const void *data, size_t size);
+    void pad();
+
+    FILE *file;
+    size_t written;
+};
+
+class SnapshotReader {
+public:
+    /**
+     * Maps the file and checks its header, exits if it is missing or of another version
+     */
+    explicit SnapshotReader(const std::string &path);
+    ~SnapshotReader();
+
+    SnapshotReader(const SnapshotReader&) = delete;
+    SnapshotReader& operator=(const SnapshotReader&) = delete;
+
+    template <typename T>
+    T read() {
+        T value;
+        readRaw(&value, sizeof(T));
+        return value;
+    }
+
+    template <typename T>
+    void readArray(std::vector<T> &values) {
+        // a corrupted count must not get as far as the allocation
+        auto count = read<uint64_t>();
+        if (count > (size - pos) / sizeof(T)) {
+            truncated();
+        }
+        values.resize(count);
+        readRaw(values.data(), values.size() * sizeof(T));
+        skipPadding();
+    }
+
+    void readArray(std::vector<bool> &values);
+
+private:
+    void readRaw(void *data, size_t size);
+    void skipPadding();
+    [[noreturn]] static void truncated();
+
+    const char *data;
+    size_t size, pos;
+    void *mapped;
+};
+
+
+#endif //PACE2018_SNAPSHOT_H
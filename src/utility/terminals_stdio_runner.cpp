@@ -1,9 +1,31 @@
 #include "terminals_stdio_runner.h"
 
-void TerminalsStdioRunner::run() {
+void TerminalsStdioRunner::run(const char *inputPath) {
+    std::unique_ptr<InputReader> input = inputPath ? std::make_unique<InputReader>(inputPath)
+                                                   : std::make_unique<InputReader>(STDIN_FILENO);
     Graph inputGraph;
-    inputGraph.load(std::cin);
+    inputGraph.load(*input);
+    inputGraph.reduce();
 
-    DreyfusWagner solver(inputGraph, TreeDecomposition());
-    Graph solution = solver.solve();
+    // the exponent of Dreyfus-Wagner is the terminal count, with many of them a narrow decomposition may do better
+    TreeDecomposition td;
+    bool useDecomposition = false;
+    if (inputGraph.getTerminals().size() >= HEURISTIC_MIN_TERMINALS) {
+        td.computeHeuristic(inputGraph, HEURISTIC_BUDGET);
+        // no budget, only the redundant elimination bags are merged
+        td.improve(inputGraph, 0);
+        if (td.getWidth() <= MAX_REDUCE_WIDTH) {
+            td.convertToNice(inputGraph);
+            useDecomposition = td.estimateDPStates(inputGraph) * ReduceDPSolver<>::STATE_COST <
+                               DreyfusWagner::estimateWork(inputGraph);
+        }
+    }
+
+    std::unique_ptr<Solver> solver;
+    if (useDecomposition) {
+        solver = makeReduceDPSolver(inputGraph, td);
+    } else {
+        solver = std::make_unique<DreyfusWagner>(inputGraph, td);
+    }
+    Graph solution = solver->solve();
 }
@@ -3,6 +3,7 @@
 
 #include <iostream>
 #include <memory>
+#include <unistd.h>
 
 #include "solvers/base_dp_solver.h"
 #include "solvers/dreyfus_wagner.h"
@@ -13,7 +14,17 @@
 
 class TerminalsStdioRunner {
 public:
-    void run();
+    /**
+     * Solves the instance read from the given file, or from the standard input if there is none
+     */
+    void run(const char *inputPath = nullptr);
+
+private:
+    // seconds spent looking for a narrow decomposition, only with many terminals
+    static constexpr double HEURISTIC_BUDGET = 2.0;
+    static const unsigned HEURISTIC_MIN_TERMINALS = 14;
+    // widest bags the reduce solver is tried on, wider ones are left to Dreyfus-Wagner
+    static const unsigned MAX_REDUCE_WIDTH = 24;
 };
 
 
@@ -0,0 +1,159 @@
+#include "thread_pool.h"
+
+namespace {
+    thread_local unsigned currentWorker = 0;
+}
+
+ThreadPool::ThreadPool(unsigned threadCount)
+        : threadCount(threadCount == 0 ? 1 : threadCount), queued(0), stopping(false) {
+    for (unsigned i = 0; i < this->threadCount; i++) {
+        queues.push_back(std::make_unique<WorkQueue>());
+    }
+    for (unsigned i = 1; i < this->threadCount; i++) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> guard(sleepLock);
+        stopping = true;
+    }
+    wakeup.notify_all();
+    for (auto &worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    unsigned id = workerId() < threadCount ? workerId() : 0;
+    {
+        std::lock_guard<std::mutex> guard(queues[id]->lock);
+        queues[id]->tasks.push_back(std::move(task));
+    }
+    queued++;
+
+    if (!workers.empty()) {
+        std::lock_guard<std::mutex> guard(sleepLock);
+        wakeup.notify_one();
+    }
+}
+
+void ThreadPool::waitUntil(const std::function<bool()> &done) {
+    while (!done()) {
+        if (!runPendingTask()) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void ThreadPool::parallelFor(unsigned begin, unsigned end,
+                             const std::function<void(unsigned)> &body) {
+    if (begin >= end) {
+        return;
+    }
+    if (threadCount == 1 || end - begin == 1) {
+        for (unsigned i = begin; i < end; i++) {
+            body(i);
+        }
+        return;
+    }
+
+    // helpers may start after the loop is over, so the shared state has to outlive this call
+    struct LoopState {
+        std::atomic<unsigned> next, finished;
+        unsigned end, total;
+        const std::function<void(unsigned)> *body;
+        std::mutex lock;
+        std::condition_variable done;
+    };
+    auto state = std::make_shared<LoopState>();
+    state->next = begin;
+    state->finished = 0;
+    state->end = end;
+    state->total = end - begin;
+    state->body = &body;
+
+    auto runIndices = [state]() {
+        unsigned idx;
+        while ((idx = state->next++) < state->end) {
+            (*state->body)(idx);
+            if (++state->finished == state->total) {
+                std::lock_guard<std::mutex> guard(state->lock);
+                state->done.notify_all();
+            }
+        }
+    };
+
+    unsigned helpers = std::min(threadCount, end - begin) - 1;
+    for (unsigned i = 0; i < helpers; i++) {
+        submit(runIndices);
+    }
+    runIndices();
+
+    // every index is taken by now, only sleep until the ones still running are over, picking up other
+    // queued tasks here would nest whole tree nodes on this stack and hold up the caller
+    std::unique_lock<std::mutex> guard(state->lock);
+    state->done.wait(guard, [&]() {
+        return state->finished == state->total;
+    });
+}
+
+unsigned ThreadPool::getThreadCount() const {
+    return threadCount;
+}
+
+unsigned ThreadPool::workerId() {
+    return currentWorker;
+}
+
+void ThreadPool::workerLoop(unsigned id) {
+    currentWorker = id;
+    while (true) {
+        if (runPendingTask()) {
+            continue;
+        }
+
+        std::unique_lock<std::mutex> guard(sleepLock);
+        wakeup.wait(guard, [this]() {
+            return stopping || queued != 0;
+        });
+        if (stopping && queued == 0) {
+            return;
+        }
+    }
+}
+
+bool ThreadPool::runPendingTask() {
+    unsigned id = workerId() < threadCount ? workerId() : 0;
+    std::function<void()> task;
+    if (!popTask(id, task) && !stealTask(id, task)) {
+        return false;
+    }
+    queued--;
+    task();
+    return true;
+}
+
+bool ThreadPool::popTask(unsigned id, std::function<void()> &task) {
+    std::lock_guard<std::mutex> guard(queues[id]->lock);
+    if (queues[id]->tasks.empty()) {
+        return false;
+    }
+    task = std::move(queues[id]->tasks.back());
+    queues[id]->tasks.pop_back();
+    return true;
+}
+
+bool ThreadPool::stealTask(unsigned id, std::function<void()> &task) {
+    for (unsigned offset = 1; offset < threadCount; offset++) {
+        WorkQueue &victim = *queues[(id + offset) % threadCount];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
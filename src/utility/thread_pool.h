@@ -0,0 +1,70 @@
+#ifndef PACE2018_THREAD_POOL_H
+#define PACE2018_THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Work-stealing thread pool
+ *
+ * Every worker owns a task deque, it pops its own tasks from the back and steals from the
+ * front of the others. The thread owning the pool takes part in the work while it waits, so a
+ * pool of size 1 spawns no threads at all and runs everything inline.
+ */
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned threadCount);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void submit(std::function<void()> task);
+
+    /**
+     * Runs queued tasks until the given condition holds
+     */
+    void waitUntil(const std::function<bool()> &done);
+
+    /**
+     * Calls body for every index in [begin, end), blocks until all calls finished. The calling thread
+     * only helps with the indices of this loop.
+     */
+    void parallelFor(unsigned begin, unsigned end, const std::function<void(unsigned)> &body);
+
+    unsigned getThreadCount() const;
+
+    /**
+     * Index of the calling thread within its pool, 0 for the owning thread
+     */
+    static unsigned workerId();
+
+private:
+    struct WorkQueue {
+        std::mutex lock;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    void workerLoop(unsigned id);
+    bool runPendingTask();
+    bool popTask(unsigned id, std::function<void()> &task);
+    bool stealTask(unsigned id, std::function<void()> &task);
+
+    unsigned threadCount;
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::vector<std::thread> workers;
+
+    std::atomic<unsigned> queued;
+    std::mutex sleepLock;
+    std::condition_variable wakeup;
+    bool stopping;
+};
+
+
+#endif //PACE2018_THREAD_POOL_H
@@ -1,24 +1,55 @@
 #include "treewidth_stdio_runner.h"
 
-void TreewidthStdioRunner::run() {
-    Graph inputGraph;
-    inputGraph.load(std::cin);
+void TreewidthStdioRunner::setSnapshotInput(const std::string &path) {
+    snapshotInput = path;
+}
+
+void TreewidthStdioRunner::setSnapshotOutput(const std::string &path) {
+    snapshotOutput = path;
+}
 
+void TreewidthStdioRunner::run(const char *inputPath) {
+    Graph inputGraph;
     TreeDecomposition td;
-    td.load(std::cin);
-//    td.printTree(std::cout);
+    if (!snapshotInput.empty()) {
+        // preprocessed instance, straight to solving
+        SnapshotReader snapshot(snapshotInput);
+        inputGraph.loadSnapshot(snapshot);
+        td.loadSnapshot(snapshot);
+    } else {
+        std::unique_ptr<InputReader> input = inputPath ? std::make_unique<InputReader>(inputPath)
+                                                       : std::make_unique<InputReader>(STDIN_FILENO);
+        inputGraph.load(*input);
+        inputGraph.reduce();
 
-    td.convertToNice(inputGraph);
-//    td.printTree(std::cout);
+        if (input->peekWord() == "SECTION") {
+            td.load(*input);
+        } else {
+            // no decomposition supplied, build one for the reduced graph
+            td.computeHeuristic(inputGraph, HEURISTIC_BUDGET);
+        }
+        td.improve(inputGraph, IMPROVE_BUDGET);
+//        td.printTree(std::cout);
+
+        td.convertToNice(inputGraph);
+//        td.printTree(std::cout);
+    }
+
+    if (!snapshotOutput.empty()) {
+        SnapshotWriter snapshot(snapshotOutput);
+        inputGraph.saveSnapshot(snapshot);
+        td.saveSnapshot(snapshot);
+    }
 
     std::unique_ptr<Solver> solver;
-    if (td.getWidth() > 16) {
-        solver = std::make_unique<DreyfusWagner>(DreyfusWagner(inputGraph, td));
+    if (td.getWidth() > MAX_REDUCE_WIDTH) {
+        solver = std::make_unique<DreyfusWagner>(inputGraph, td);
     } else {
-        if (inputGraph.getTerminals().size() < 14) {
-            solver = std::make_unique<DreyfusWagner>(DreyfusWagner(inputGraph, td));
+        if (inputGraph.getTerminals().size() < 14 ||
+                DreyfusWagner::estimateWork(inputGraph) < td.estimateDPStates(inputGraph) * ReduceDPSolver<>::STATE_COST) {
+            solver = std::make_unique<DreyfusWagner>(inputGraph, td);
         } else {
-            solver = std::make_unique<ReduceDPSolver>(ReduceDPSolver(inputGraph, td));
+            solver = makeReduceDPSolver(inputGraph, td);
 
         }
     }
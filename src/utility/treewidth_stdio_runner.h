@@ -3,6 +3,8 @@
 
 #include <iostream>
 #include <memory>
+#include <string>
+#include <unistd.h>
 
 #include "solvers/base_dp_solver.h"
 #include "solvers/dreyfus_wagner.h"
@@ -13,7 +15,30 @@
 
 class TreewidthStdioRunner {
 public:
-    void run();
+    /**
+     * Solves the instance read from the given file, or from the standard input if there is none
+     */
+    void run(const char *inputPath = nullptr);
+
+    /**
+     * Reads the preprocessed graph and nice decomposition from a snapshot instead of parsing
+     */
+    void setSnapshotInput(const std::string &path);
+
+    /**
+     * Writes the preprocessed graph and nice decomposition to a snapshot before solving
+     */
+    void setSnapshotOutput(const std::string &path);
+
+private:
+    std::string snapshotInput, snapshotOutput;
+
+    // seconds spent on the elimination heuristic when the input has no decomposition
+    static constexpr double HEURISTIC_BUDGET = 1.0;
+    // seconds spent narrowing the decomposition before it is made nice
+    static constexpr double IMPROVE_BUDGET = 1.0;
+    // widest bags the reduce solver is tried on, wider ones are left to Dreyfus-Wagner
+    static const unsigned MAX_REDUCE_WIDTH = 24;
 };
 
 
@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+
+#include "structures/cut_matrix.h"
+#include "utility/partitioner.h"
+
+// dense elimination over rows built cut by cut, the last subset member always on the zero side
+static std::vector<uint64_t> referenceBasis(const std::vector<uint64_t> &partitions, unsigned subset, unsigned size) {
+    unsigned memberCount = (unsigned)__builtin_popcount(subset), cutCount = 1u << (memberCount - 1);
+    std::vector<std::vector<bool>> basis;
+    std::vector<uint64_t> kept;
+    for (auto partition : partitions) {
+        std::vector<bool> row(cutCount);
+        for (unsigned cutSubset = 0; cutSubset < cutCount; cutSubset++) {
+            unsigned cut = depositBits(cutSubset, subset), isInZero = 0, isInOne = 0;
+            for (unsigned i = 0; i < size; i++) {
+                if (isInSubset(i, subset)) {
+                    (isInSubset(i, cut) ? isInOne : isInZero) |= 1u << (unsigned)getComponentAt(partition, i);
+                }
+            }
+            row[cutSubset] = (isInOne & isInZero) == 0;
+        }
+        for (auto &other : basis) {
+            auto pivot = (unsigned)(std::find(other.begin(), other.end(), true) - other.begin());
+            if (row[pivot]) {
+                for (unsigned i = 0; i < cutCount; i++) {
+                    row[i] = row[i] != other[i];
+                }
+            }
+        }
+        if (std::find(row.begin(), row.end(), true) != row.end()) {
+            basis.push_back(row);
+            kept.push_back(partition);
+        }
+    }
+    return kept;
+}
+
+TEST(CutMatrix, MatchesDenseElimination) {
+    std::mt19937 random(2018);
+    // subsets with gaps, up to 8 members so the rows span several words
+    for (unsigned subset : {0b1u, 0b101u, 0b1101u, 0b111011u, 0b1101111u, 0b11110111u, 0b111111101u, 0b1011111101u}) {
+        unsigned size = 32 - (unsigned)__builtin_clz(subset), memberCount = (unsigned)__builtin_popcount(subset);
+        Partitioner partitioner(0, subset, size);
+        partitioner.compute();
+        std::vector<uint64_t> partitions = partitioner.getResult();
+        std::shuffle(partitions.begin(), partitions.end(), random);
+
+        CutMatrix<uint64_t> matrix(subset, size);
+        CutMatrix<uint128_t> matrix128(subset, size);
+        std::vector<uint64_t> kept;
+        for (auto partition : partitions) {
+            if (matrix.insert(partition)) {
+                kept.push_back(partition);
+            }
+            EXPECT_FALSE(matrix.insert(partition));
+            matrix128.insert(vecToPartition<uint128_t>(partitionToVec(size, partition), subset));
+        }
+        EXPECT_EQ(referenceBasis(partitions, subset, size), kept);
+        EXPECT_EQ(kept, matrix.getPartitions());
+
+        // all partitions span every cut, in any encoding
+        EXPECT_TRUE(matrix.isFull());
+        EXPECT_EQ(1u << (memberCount - 1), kept.size());
+        ASSERT_EQ(kept.size(), matrix128.getPartitions().size());
+        for (unsigned i = 0; i < kept.size(); i++) {
+            EXPECT_EQ(partitionToVec(size, kept[i]), partitionToVec(size, matrix128.getPartitions()[i]));
+        }
+    }
+}
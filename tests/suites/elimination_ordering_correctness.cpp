@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+#include <fstream>
+#include <algorithm>
+
+#include "structures/graph.h"
+#include "structures/tree_decomposition.h"
+#include "utility/elimination_ordering.h"
+
+TEST(EliminationOrdering, ValidDecomposition) {
+    Graph g;
+    std::ifstream simple2("tests/inputs/simple2.grtd");
+    g.load(simple2);
+
+    EliminationOrdering ordering(g);
+    ordering.compute(0.1);
+    std::vector<std::vector<int>> bags;
+    std::vector<std::pair<int, int>> treeEdges;
+    ordering.getDecomposition(bags, treeEdges);
+
+    ASSERT_EQ((size_t)g.getNodeCount(), bags.size());
+    ASSERT_EQ(bags.size() - 1, treeEdges.size());
+    unsigned width = 0;
+    for (auto &bag : bags) {
+        width = std::max(width, (unsigned)bag.size());
+    }
+    EXPECT_EQ(width, ordering.getWidth());
+
+    // every edge is covered by a bag
+    for (int node = 0; node < g.getNodeCount(); node++) {
+        for (unsigned arc = g.arcBegin(node); arc < g.arcEnd(node); arc++) {
+            int target = g.arcTarget(arc);
+            bool covered = false;
+            for (auto &bag : bags) {
+                covered |= std::count(bag.begin(), bag.end(), node) && std::count(bag.begin(), bag.end(), target);
+            }
+            EXPECT_TRUE(covered);
+        }
+    }
+
+    // bags holding a node form a connected subtree, with n - 1 edges this also makes the whole thing a tree
+    std::vector<std::vector<int>> tree(bags.size());
+    for (auto &edge : treeEdges) {
+        tree[edge.first].push_back(edge.second);
+        tree[edge.second].push_back(edge.first);
+    }
+    for (int node = 0; node < g.getNodeCount(); node++) {
+        auto holds = [&](int bag) {
+            return std::count(bags[bag].begin(), bags[bag].end(), node) > 0;
+        };
+        std::vector<int> stack;
+        std::vector<bool> seen(bags.size(), false);
+        unsigned holding = 0, reached = 0;
+        for (unsigned bag = 0; bag < bags.size(); bag++) {
+            if (holds(bag)) {
+                holding++;
+                if (stack.empty()) {
+                    stack.push_back(bag);
+                    seen[bag] = true;
+                }
+            }
+        }
+        while (!stack.empty()) {
+            int bag = stack.back();
+            stack.pop_back();
+            reached++;
+            for (auto adj : tree[bag]) {
+                if (!seen[adj] && holds(adj)) {
+                    seen[adj] = true;
+                    stack.push_back(adj);
+                }
+            }
+        }
+        EXPECT_EQ(holding, reached);
+    }
+}
+
+TEST(EliminationOrdering, HeuristicDecomposition) {
+    Graph g;
+    std::ifstream simple3("tests/inputs/simple3.grtd");
+    g.load(simple3);
+    g.reduce();
+
+    TreeDecomposition td;
+    td.computeHeuristic(g, 0.1);
+    td.convertToNice(g);
+
+    // nice decomposition rooted in an empty bag, every live node is forgotten exactly once
+    unsigned forgets = 0;
+    for (unsigned i = 0; i < td.getNodeCount(); i++) {
+        forgets += td.getNodeAt(i).type == TreeDecomposition::FORGET ? 1 : 0;
+    }
+    unsigned live = 0;
+    for (int node = 0; node < g.getNodeCount(); node++) {
+        live += g.isNodeErased(node) ? 0 : 1;
+    }
+    EXPECT_EQ(live, forgets);
+    EXPECT_TRUE(td.getBagOf(0).empty());
+}
+
+TEST(EliminationOrdering, OutOfTime) {
+    Graph g;
+    std::ifstream simple2("tests/inputs/simple2.grtd");
+    g.load(simple2);
+
+    // with the deadline already gone min-degree leaves every node in a single bag
+    EliminationOrdering ordering(g);
+    ordering.compute(-1.0);
+    std::vector<std::vector<int>> bags;
+    std::vector<std::pair<int, int>> treeEdges;
+    ordering.getDecomposition(bags, treeEdges);
+
+    ASSERT_EQ(1u, bags.size());
+    EXPECT_TRUE(treeEdges.empty());
+    EXPECT_EQ((size_t)g.getNodeCount(), bags[0].size());
+    EXPECT_EQ((unsigned)g.getNodeCount(), ordering.getWidth());
+    EXPECT_EQ((size_t)g.getNodeCount(), ordering.getOrder().size());
+}
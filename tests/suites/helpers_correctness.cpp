@@ -87,6 +87,37 @@ TEST(Helpers, VecToPartition) {
     EXPECT_PRED_FORMAT2(assertHexaValues, vecToPartition(vec4, subset3), partition4_3);
 }
 
+TEST(Helpers, WidePartitions) {
+    std::vector<char> vec = {7, 7, 3, 9, 0, 3, 12, 7,
+                             1, 9, 4, 4, 5, 11, 2, 6,
+                             8, 10, 13, 0, 3, 14, 15, 16};
+    std::vector<char> canonical = {0, 0, 1, 2, 3, 1, 4, 0,
+                                   5, 2, 6, 6, 7, 8, 9, 10,
+                                   11, 12, 13, 3, 1, 14, 15, 16};
+    unsigned subset = 0xFFFFFF;
+
+    auto partition128 = vecToPartition<uint128_t>(vec, subset);
+    EXPECT_EQ(canonical, partitionToVec(24, partition128));
+    EXPECT_EQ(16, maxComponentIn(partition128, 24));
+
+    auto partitionArray = vecToPartition<std::array<uint64_t, 4>>(vec, subset);
+    EXPECT_EQ(canonical, partitionToVec(24, partitionArray));
+
+    // fields beyond the first word are independent
+    setComponentAt(partition128, 20, 31);
+    setComponentAt(partitionArray, 20, 200);
+    EXPECT_EQ(31, getComponentAt(partition128, 20));
+    EXPECT_EQ(200, getComponentAt(partitionArray, 20));
+    EXPECT_EQ(3, getComponentAt(partition128, 19));
+    EXPECT_EQ(14, getComponentAt(partitionArray, 21));
+
+    // vertices outside of the subset stay zero
+    partition128 = vecToPartition<uint128_t>(vec, 0xF00000);
+    EXPECT_EQ(0, getComponentAt(partition128, 19));
+    EXPECT_EQ(0, getComponentAt(partition128, 20));
+    EXPECT_EQ(3, getComponentAt(partition128, 23));
+}
+
 TEST(Helpers, MaskWithoutElement) {
     int mask1 = 0b00001010,
         ref1  = 0b00000110;
@@ -126,6 +157,124 @@ TEST(Helpers, GetComponentAt) {
     }
 }
 
+/**
+ * Calls the check with every vector of the given size over the values 0..size-1
+ */
+template <typename Check>
+void forAllVectors(unsigned size, Check check) {
+    std::vector<char> vec(size, 0);
+    while (true) {
+        check(vec);
+        unsigned i = 0;
+        while (i < size && ++vec[i] == (char)size) {
+            vec[i++] = 0;
+        }
+        if (i == size) {
+            return;
+        }
+    }
+}
+
+template <typename Partition>
+Partition packRaw(const std::vector<char> &vec) {
+    Partition partition{};
+    for (unsigned i = 0; i < vec.size(); i++) {
+        setComponentAt(partition, i, (unsigned char)vec[i]);
+    }
+    return partition;
+}
+
+TEST(Helpers, PackedPartitionsMatchVectors) {
+    for (unsigned size = 1; size <= 5; size++) {
+        forAllVectors(size, [&](const std::vector<char> &vec) {
+            uint64_t raw = packRaw<uint64_t>(vec);
+            auto raw128 = packRaw<uint128_t>(vec);
+            for (unsigned subset = 0; subset < (1u << size); subset++) {
+                uint64_t canonical = vecToPartition(vec, subset);
+                ASSERT_EQ(canonical, canonizePartition(raw, subset, size));
+                ASSERT_TRUE(vecToPartition<uint128_t>(vec, subset) == canonizePartition(raw128, subset, size));
+
+                for (unsigned at = 0; at < size; at++) {
+                    // erasing, the subset is given for the shorter vector
+                    unsigned shorter = subset & lowBits(size - 1);
+                    ASSERT_EQ(partitionWithoutElement(vec, at, shorter),
+                              canonizePartition(eraseComponentAt(raw, at, size), shorter, size - 1));
+                    ASSERT_TRUE(partitionWithoutElement<uint128_t>(vec, at, shorter) ==
+                                canonizePartition(eraseComponentAt(raw128, at, size), shorter, size - 1));
+
+                    // relabeling one component to another, restricted to the subset
+                    std::vector<char> relabeled = vec;
+                    for (unsigned i = 0; i < size; i++) {
+                        if (isInSubset(i, subset) && relabeled[i] == vec[at]) {
+                            relabeled[i] = vec[0];
+                        }
+                    }
+                    ASSERT_EQ(packRaw<uint64_t>(relabeled),
+                              relabelComponent(raw, (unsigned)vec[at], (unsigned)vec[0], subset, size));
+                    ASSERT_TRUE(packRaw<uint128_t>(relabeled) ==
+                                relabelComponent(raw128, (unsigned)vec[at], (unsigned)vec[0], subset, size));
+                }
+
+                for (unsigned at = 0; at <= size; at++) {
+                    // inserting a fresh component and one of the present ones
+                    unsigned longer = subset | (1u << size);
+                    for (auto value : {(char)size, vec[0]}) {
+                        std::vector<char> inserted = vec;
+                        inserted.insert(inserted.begin() + at, value);
+                        ASSERT_EQ(vecToPartition(inserted, longer),
+                                  canonizePartition(insertComponentAt(raw, at, (unsigned)value, size), longer, size + 1));
+                        ASSERT_TRUE(vecToPartition<uint128_t>(inserted, longer) ==
+                                    canonizePartition(insertComponentAt(raw128, at, (unsigned)value, size),
+                                                      longer, size + 1));
+                    }
+                }
+            }
+        });
+    }
+}
+
+TEST(Helpers, MasksMatchScalar) {
+    for (unsigned size = 0; size <= 8; size++) {
+        for (unsigned mask = 0; mask < (1u << size); mask++) {
+            for (unsigned id = 0; id <= size; id++) {
+                // bit by bit reference
+                unsigned without = 0, with0 = 0, with1 = 0, shift = 0;
+                for (unsigned i = 0; i < size; i++) {
+                    if (i == id) {
+                        with1 |= 1u << shift++;
+                    }
+                    with0 |= ((mask >> i) & 1u) << shift;
+                    with1 |= ((mask >> i) & 1u) << shift++;
+                    if (i != id) {
+                        without |= ((mask >> i) & 1u) << (i < id ? i : i - 1);
+                    }
+                }
+                if (id == size) {
+                    with1 |= 1u << shift;
+                }
+                ASSERT_EQ(with0, maskWithElement(mask, id, 0, size));
+                ASSERT_EQ(with1, maskWithElement(mask, id, 1, size));
+                if (id < size) {
+                    ASSERT_EQ(without, maskWithoutElement(mask, id, size));
+                }
+            }
+
+            for (unsigned target = 0; target < 256; target++) {
+                unsigned deposited = 0, extracted = 0, bit = 0;
+                for (unsigned i = 0; i < 8; i++) {
+                    if ((target >> i) & 1u) {
+                        deposited |= ((mask >> bit) & 1u) << i;
+                        extracted |= ((mask >> i) & 1u) << bit;
+                        bit++;
+                    }
+                }
+                ASSERT_EQ(deposited, depositBits(mask, target));
+                ASSERT_EQ(extracted, extractBits(mask, target));
+            }
+        }
+    }
+}
+
 /* TODO: fix for new mergers
 TEST(Helpers, CyclicMerge) {
     uint64_t a1   = 0x2110,
@@ -146,3 +295,33 @@ TEST(Helpers, CyclicMerge) {
     EXPECT_EQ(ref3, cyclicMerge(a3, b3, 6, subset3));
 }
  */
+
+TEST(Helpers, PartitionRanks) {
+    std::vector<uint64_t> bell = {1, 1, 2, 5, 15, 52, 203, 877, 4140, 21147, 115975, 678570, 4213597,
+                                  27644437, 190899322, 1382958545, 10480142147};
+    for (unsigned size = 0; size <= 16; size++) {
+        ASSERT_EQ(bell[size], partitionCount(size));
+    }
+
+    for (unsigned size = 0; size <= 9; size++) {
+        std::vector<char> previous;
+        for (uint64_t rank = 0; rank < partitionCount(size); rank++) {
+            uint64_t partition = unrankPartition(rank, size);
+            ASSERT_EQ(partition, canonizePartition(partition, lowBits(size), size));
+            ASSERT_EQ(rank, rankPartition(partition, size));
+
+            std::vector<char> vec = partitionToVec(size, partition);
+            if (rank > 0) {
+                ASSERT_LT(previous, vec);
+            }
+            previous = vec;
+        }
+    }
+
+    // the extremes of the widest bags
+    EXPECT_EQ(0u, unrankPartition(0, 16));
+    EXPECT_EQ(0xFEDCBA9876543210, unrankPartition(partitionCount(16) - 1, 16));
+    for (uint64_t rank = 0; rank < partitionCount(16); rank += 104729) {
+        ASSERT_EQ(rank, rankPartition(unrankPartition(rank, 16), 16));
+    }
+}
@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+#include <sstream>
+
+#include "structures/graph.h"
+#include "structures/tree_decomposition.h"
+#include "utility/input_reader.h"
+
+TEST(InputReader, Tokens) {
+    std::istringstream input("c leading comment\nSECTION Graph\n  c indented comment\nNodes 12\nb 3 -4 5\nb\nEND\nrest");
+    InputReader reader(input, 1);
+
+    EXPECT_EQ("SECTION", reader.readWord());
+    EXPECT_EQ("Graph", reader.readWord());
+    EXPECT_EQ("Nodes", reader.readWord());
+    EXPECT_EQ(12, reader.readInt());
+
+    long long value = 0;
+    EXPECT_EQ("b", reader.readWord());
+    EXPECT_TRUE(reader.readIntOnLine(value));
+    EXPECT_EQ(3, value);
+    EXPECT_TRUE(reader.readIntOnLine(value));
+    EXPECT_EQ(-4, value);
+    EXPECT_TRUE(reader.readIntOnLine(value));
+    EXPECT_EQ(5, value);
+    EXPECT_FALSE(reader.readIntOnLine(value));
+
+    EXPECT_EQ("b", reader.readWord());
+    EXPECT_FALSE(reader.readIntOnLine(value));
+    EXPECT_EQ("END", reader.readWord());
+    EXPECT_TRUE(reader.atEnd());
+
+    // the stream stops right after the section
+    std::string rest;
+    input >> rest;
+    EXPECT_EQ("rest", rest);
+}
+
+TEST(InputReader, CommentedInstance) {
+    std::istringstream input("SECTION Graph\nc comment\nNodes 3\nEdges 3\nE 1 2 5\nc comment\nE 2 3 7\nE 1 3 9\nEND\n\n"
+                             "SECTION Terminals\nTerminals 2\nT 1\nc comment\nT 3\nEND\n\n"
+                             "SECTION Tree Decomposition\nc comment\ns td 2 3 3\nb 1 1 2 3\nc comment\nb 2 2 3\n1 2\nEND\n");
+    Graph g;
+    g.load(input);
+    TreeDecomposition td;
+    td.load(input);
+
+    EXPECT_EQ(3, g.getNodeCount());
+    EXPECT_EQ(3, g.getEdgeCount());
+    EXPECT_EQ(7, g.getEdgeWeight(1, 2));
+    EXPECT_TRUE(g.isTerm(2));
+
+    EXPECT_EQ(2u, td.getNodeCount());
+    std::vector<int> bag = {1, 2};
+    EXPECT_EQ(bag, td.getBagOf(1));
+    std::vector<int> adjacent = {1};
+    EXPECT_EQ(adjacent, td.getAdjacentTo(0));
+}
+
+TEST(InputReader, MalformedInteger) {
+    // a broken edge line must not turn into an edge to the first vertex
+    EXPECT_EXIT({
+        std::istringstream input("E 1 x 5\nEND\n");
+        InputReader reader(input, 1);
+        reader.readWord();
+        reader.readInt();
+        reader.readInt();
+    }, ::testing::ExitedWithCode(1), "Expected an integer, got \"x\"");
+
+    EXPECT_EXIT({
+        std::istringstream input("Nodes 12b\n");
+        InputReader reader(input, 1);
+        reader.readWord();
+        reader.readInt();
+    }, ::testing::ExitedWithCode(1), "Expected an integer");
+
+    EXPECT_EXIT({
+        std::istringstream input("Nodes\n");
+        InputReader reader(input, 1);
+        reader.readWord();
+        reader.readInt();
+    }, ::testing::ExitedWithCode(1), "Unexpected end of input");
+}
@@ -1,6 +1,9 @@
 #include <gtest/gtest.h>
+#include <random>
 
+#include "utility/forward_join.h"
 #include "utility/partition_mergers.h"
+#include "utility/partitioner.h"
 
 TEST(Mergers, VectorDFSMerger) {
     uint64_t a1   = 0x2110,
@@ -61,3 +64,83 @@ TEST(Mergers, UnionFindMerger) {
     UnionFindMerger merger3(ref3, 6, 0b111111);
     EXPECT_EQ(PARTITION_INVALID, merger3.merge(a3, b3));
 }
+
+TEST(Mergers, UnionFindMergerWide) {
+    // 20 vertices chained by alternating pairs end up in one component
+    std::vector<char> vec1, vec2;
+    for (char i = 0; i < 20; i++) {
+        vec1.push_back(i >> 1);
+        vec2.push_back((i + 1) >> 1);
+    }
+    UnionFindMerger merger1(20, 0xFFFFF);
+    auto a1 = vecToPartition<uint128_t>(vec1, 0xFFFFF),
+         b1 = vecToPartition<uint128_t>(vec2, 0xFFFFF);
+    EXPECT_TRUE(merger1.join(a1, b1) == uint128_t(0));
+
+    // the same pair in both partitions closes a cycle
+    EXPECT_TRUE(merger1.join(a1, a1) == PartitionTraits<uint128_t>::empty());
+
+    // narrow partitions give the same result in any encoding
+    UnionFindMerger merger2(6, 0b111111);
+    std::vector<char> vec3 = {0, 0, 1, 2, 3, 4}, vec4 = {0, 1, 1, 2, 2, 3};
+    auto merged = merger2.join(vecToPartition<std::array<uint64_t, 2>>(vec3, 0b111111),
+                               vecToPartition<std::array<uint64_t, 2>>(vec4, 0b111111));
+    std::vector<char> ref = {0, 0, 0, 1, 1, 2};
+    EXPECT_EQ(ref, partitionToVec(6, merged));
+    EXPECT_EQ(ref, partitionToVec(6, merger2.merge(vecToPartition(vec3, 0b111111), vecToPartition(vec4, 0b111111))));
+}
+
+TEST(Mergers, ForwardJoin) {
+    const unsigned INFTY = 1000000;
+    std::mt19937 random(2018);
+    // the catalogue joins up to 7 elements, the union find takes over at 8
+    for (unsigned size = 1; size <= 8; size++) {
+        uint64_t count = partitionCount(size);
+        std::vector<unsigned> costs1(count, INFTY), costs2(count, INFTY);
+        for (uint64_t rank = 0; rank < count; rank++) {
+            // few reachable states, as in the solvers
+            if (random() % 8 == 0 || count < 20) {
+                costs1[rank] = (unsigned)(random() % 50);
+            }
+            if (random() % 8 == 0 || count < 20) {
+                costs2[rank] = (unsigned)(random() % 50);
+            }
+        }
+        ForwardJoin join(costs1, costs2, size, INFTY);
+        join.compute();
+
+        // reference pairs up the refinements of every parent on its own
+        unsigned all = lowBits(size);
+        UnionFindMerger merger(size, all);
+        for (uint64_t rank = 0; rank < count; rank++) {
+            uint64_t partition = unrankPartition(rank, size);
+            Partitioner partitioner(partition, all, size);
+            partitioner.compute();
+            std::vector<uint64_t> refinements;
+            for (auto refinement : partitioner.getResult()) {
+                uint64_t refinementRank = rankPartition(refinement, size);
+                if (costs1[refinementRank] < INFTY || costs2[refinementRank] < INFTY) {
+                    refinements.push_back(refinement);
+                }
+            }
+
+            unsigned reference = INFTY;
+            for (auto p1 : refinements) {
+                for (auto p2 : refinements) {
+                    unsigned candidate = costs1[rankPartition(p1, size)] + costs2[rankPartition(p2, size)];
+                    if (candidate < reference && merger.merge(p1, p2) == partition) {
+                        reference = candidate;
+                    }
+                }
+            }
+            ASSERT_EQ(reference, join.getResult()[rank]);
+
+            if (reference < INFTY) {
+                auto choice = join.getChoice(rank);
+                EXPECT_EQ(reference, costs1[choice.first] + costs2[choice.second]);
+                EXPECT_EQ(partition, merger.merge(unrankPartition(choice.first, size),
+                                                  unrankPartition(choice.second, size)));
+            }
+        }
+    }
+}
@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+#include <set>
+
+#include "utility/partition_catalogue.h"
+#include "utility/partition_mergers.h"
+#include "utility/partitioner.h"
+
+TEST(PartitionCatalogue, DenseIndices) {
+    const PartitionCatalogue &catalogue = PartitionCatalogue::get();
+    std::vector<unsigned> bell = {1, 1, 2, 5, 15, 52, 203, 877, 4140};
+    for (unsigned size = 0; size <= PartitionCatalogue::MAX_SIZE; size++) {
+        ASSERT_EQ(bell[size], catalogue.count(size));
+
+        std::vector<char> previous;
+        for (unsigned i = 0; i < catalogue.count(size); i++) {
+            uint64_t partition = catalogue.partitionAt(size, i);
+            EXPECT_EQ(i, catalogue.indexOf(size, partition));
+            EXPECT_EQ(partition, canonizePartition(partition, lowBits(size), size));
+            EXPECT_EQ((unsigned)maxComponentIn(partition, size) + (size > 0 ? 1 : 0), catalogue.blockCount(size, i));
+
+            // restricted growth strings in lexicographic order
+            std::vector<char> vec = partitionToVec(size, partition);
+            if (i > 0) {
+                EXPECT_LT(previous, vec);
+            }
+            previous = vec;
+        }
+    }
+}
+
+TEST(PartitionCatalogue, Transitions) {
+    const PartitionCatalogue &catalogue = PartitionCatalogue::get();
+    for (unsigned size = 1; size <= PartitionCatalogue::MAX_SIZE; size++) {
+        unsigned all = lowBits(size);
+        for (unsigned i = 0; i < catalogue.count(size); i++) {
+            uint64_t partition = catalogue.partitionAt(size, i);
+            for (unsigned at = 0; at < size; at++) {
+                uint64_t erased = canonizePartition(eraseComponentAt(partition, at, size), lowBits(size - 1), size - 1);
+                ASSERT_EQ(erased, catalogue.partitionAt(size - 1, catalogue.erased(size, at, i)));
+
+                bool alone = true;
+                for (unsigned other = 0; other < size; other++) {
+                    alone &= other == at || getComponentAt(partition, other) != getComponentAt(partition, at);
+                }
+                ASSERT_EQ(alone, catalogue.isSingleton(size, at, i));
+
+                for (unsigned second = 0; second < size; second++) {
+                    uint64_t merged = canonizePartition(
+                            relabelComponent(partition, (unsigned)getComponentAt(partition, second),
+                                             (unsigned)getComponentAt(partition, at), all, size), all, size);
+                    ASSERT_EQ(merged, catalogue.partitionAt(size, catalogue.merged(size, at, second, i)));
+                }
+            }
+
+            if (size < PartitionCatalogue::MAX_SIZE) {
+                for (unsigned at = 0; at <= size; at++) {
+                    for (unsigned block = 0; block <= catalogue.blockCount(size, i); block++) {
+                        uint64_t inserted = canonizePartition(insertComponentAt(partition, at, block, size),
+                                                              lowBits(size + 1), size + 1);
+                        ASSERT_EQ(inserted, catalogue.partitionAt(size + 1, catalogue.inserted(size, at, block, i)));
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST(PartitionCatalogue, Splits) {
+    const PartitionCatalogue &catalogue = PartitionCatalogue::get();
+    for (unsigned size = 2; size <= 6; size++) {
+        for (unsigned first = 0; first < size; first++) {
+            for (unsigned second = 0; second < size; second++) {
+                // every partition with both in separate blocks splits the one it merges to
+                std::vector<std::set<unsigned>> reference(catalogue.count(size));
+                for (unsigned i = 0; i < catalogue.count(size); i++) {
+                    uint64_t partition = catalogue.partitionAt(size, i);
+                    if (getComponentAt(partition, first) != getComponentAt(partition, second)) {
+                        reference[catalogue.merged(size, first, second, i)].insert(i);
+                    }
+                }
+                for (unsigned i = 0; i < catalogue.count(size); i++) {
+                    auto splits = catalogue.splits(size, first, second, i);
+                    std::set<unsigned> result(splits.first, splits.second);
+                    ASSERT_EQ(reference[i], result);
+                    ASSERT_EQ(reference[i].size(), (size_t)(splits.second - splits.first));
+                }
+            }
+        }
+    }
+}
+
+TEST(PartitionCatalogue, RefinementsAndJoins) {
+    const PartitionCatalogue &catalogue = PartitionCatalogue::get();
+    for (unsigned size = 0; size <= 6; size++) {
+        unsigned all = lowBits(size);
+        UnionFindMerger merger(size, all);
+        for (unsigned i = 0; i < catalogue.count(size); i++) {
+            uint64_t partition = catalogue.partitionAt(size, i);
+            Partitioner partitioner(partition, all, size);
+            partitioner.compute();
+            std::set<uint64_t> reference(partitioner.getResult().begin(), partitioner.getResult().end()), result;
+            auto refinements = catalogue.refinements(size, i);
+            for (auto it = refinements.first; it != refinements.second; ++it) {
+                result.insert(catalogue.partitionAt(size, *it));
+            }
+            ASSERT_EQ(reference, result);
+
+            for (unsigned j = 0; j < catalogue.count(size); j++) {
+                uint64_t joined = merger.merge(partition, catalogue.partitionAt(size, j));
+                unsigned index = catalogue.joined(size, i, j);
+                if (joined == PARTITION_INVALID) {
+                    ASSERT_EQ(PartitionCatalogue::NONE, index);
+                } else {
+                    ASSERT_EQ(joined, catalogue.partitionAt(size, index));
+                }
+            }
+        }
+    }
+}
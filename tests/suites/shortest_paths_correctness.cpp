@@ -0,0 +1,43 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <climits>
+#include <fstream>
+#include <vector>
+
+#include "structures/graph.h"
+#include "utility/shortest_paths.h"
+
+TEST(ShortestPaths, RadixHeapOrder) {
+    RadixHeap heap;
+    std::vector<unsigned> keys = {7, 3, 3, 12, 1000, 5, 64, 65, 3};
+    for (unsigned i = 0; i < keys.size(); i++) {
+        heap.push(keys[i], i);
+    }
+    std::sort(keys.begin(), keys.end());
+    for (unsigned i = 0; i < 4; i++) {
+        EXPECT_EQ(keys[i], heap.pop().first);
+    }
+    // keys pushed after popping must not be smaller than the last popped one
+    heap.push(6, 100);
+    EXPECT_EQ(6u, heap.pop().first);
+    EXPECT_EQ(7u, heap.pop().first);
+    heap.clear();
+    EXPECT_TRUE(heap.empty());
+}
+
+TEST(ShortestPaths, QueuesAgree) {
+    Graph g;
+    std::ifstream simple1("tests/inputs/simple1.gr", std::ios::in);
+    g.load(simple1);
+
+    const unsigned infinity = UINT_MAX >> 1u;
+    auto n = (unsigned)g.getNodeCount();
+    for (unsigned source = 0; source < n; source++) {
+        std::vector<unsigned> radixDist(n, infinity), binaryDist(n, infinity);
+        radixDist[source] = binaryDist[source] = 0;
+        ShortestPaths(ShortestPaths::Queue::RADIX_HEAP).relax(g, radixDist.data(), nullptr, infinity);
+        ShortestPaths(ShortestPaths::Queue::BINARY_HEAP).relax(g, binaryDist.data(), nullptr, infinity);
+        EXPECT_EQ(binaryDist, radixDist);
+        EXPECT_EQ(0u, radixDist[source]);
+    }
+}
@@ -0,0 +1,55 @@
+#include <gtest/gtest.h>
+#include <map>
+
+#include "structures/state_table.h"
+
+TEST(StateTable, InsertOrImprove) {
+    StateTable<int> table;
+    auto entry = table.improve(0x210, 10);
+    ASSERT_NE(nullptr, entry);
+    entry->handle = 1;
+
+    // worse or equal cost keeps the stored state
+    EXPECT_EQ(nullptr, table.improve(0x210, 10));
+    EXPECT_EQ(nullptr, table.improve(0x210, 12));
+    EXPECT_EQ(10u, table.costOf(0x210));
+    EXPECT_EQ(1, table.handleOf(0x210));
+
+    // better cost is reported back to the caller
+    entry = table.improve(0x210, 7);
+    ASSERT_NE(nullptr, entry);
+    entry->handle = 2;
+    EXPECT_EQ(7u, table.costOf(0x210));
+    EXPECT_EQ(2, table.handleOf(0x210));
+    EXPECT_EQ(1u, table.size());
+    EXPECT_FALSE(table.contains(0x0));
+}
+
+TEST(StateTable, GrowAndIterate) {
+    StateTable<uint64_t> table;
+    std::map<uint64_t, unsigned> reference;
+    for (uint64_t i = 0; i < 5000; i++) {
+        uint64_t partition = (i * 7919) % 4096;
+        auto cost = (unsigned)((i * 31) % 97);
+        auto entry = table.improve(partition, cost);
+        if (reference.count(partition) == 0 || reference[partition] > cost) {
+            reference[partition] = cost;
+            ASSERT_NE(nullptr, entry);
+            entry->handle = partition;
+        } else {
+            EXPECT_EQ(nullptr, entry);
+        }
+    }
+
+    EXPECT_EQ(reference.size(), table.size());
+    std::map<uint64_t, unsigned> iterated;
+    for (auto &entry : table) {
+        EXPECT_EQ(entry.partition, entry.handle);
+        iterated[entry.partition] = entry.cost;
+    }
+    EXPECT_EQ(reference, iterated);
+
+    table.clear();
+    EXPECT_TRUE(table.empty());
+    EXPECT_EQ(table.begin(), table.end());
+}
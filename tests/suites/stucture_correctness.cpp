@@ -1,8 +1,11 @@
 #include <gtest/gtest.h>
+#include <cstdio>
 #include <fstream>
 #include <map>
+#include <sstream>
 
 #include "structures/graph.h"
+#include "structures/solution_dag.h"
 #include "structures/tree_decomposition.h"
 
 TEST(Structures, GraphSimple) {
@@ -23,6 +26,59 @@ TEST(Structures, GraphSimple) {
     EXPECT_EQ(g.getAdjacentOf(2), edgesOf2);
 }
 
+TEST(Structures, GraphCsr) {
+    Graph g;
+    std::ifstream simple1("tests/inputs/simple1.gr", std::ios::in);
+    g.load(simple1);
+
+    // rows agree with the adjacency maps
+    for (int node = 0; node < g.getNodeCount(); node++) {
+        std::map<int, int> row;
+        for (unsigned arc = g.arcBegin(node); arc < g.arcEnd(node); arc++) {
+            row[g.arcTarget(arc)] = g.arcWeight(arc);
+            std::pair<int, int> edge = std::minmax(node, g.arcTarget(arc));
+            EXPECT_EQ(g.edgeWithId(g.arcEdgeId(arc)), edge);
+        }
+        EXPECT_EQ(g.getAdjacentOf(node), row);
+    }
+
+    EXPECT_EQ(10, g.getEdgeWeight(4, 2));
+    EXPECT_EQ(-1, g.findArc(0, 2));
+    EXPECT_EQ(g.idOfEdge({1, 3}), g.arcEdgeId((unsigned)g.findArc(3, 1)));
+}
+
+TEST(Structures, GraphLeafCut) {
+    Graph g;
+    std::ifstream path("tests/inputs/path_of_len_5.grtd", std::ios::in);
+    g.load(path);
+
+    // the whole path collapses, only the edges between the terminals are kept
+    EXPECT_EQ(4, g.getLeafCutReport().removedNodes);
+    EXPECT_EQ(4, g.getLeafCutReport().removedEdges);
+    EXPECT_EQ(17u, g.getLeafCutReport().preselectedWeight);
+    EXPECT_EQ(17, g.getPreselectedWeight());
+    EXPECT_EQ(2u, g.getPreselectedEdges().size());
+}
+
+TEST(Structures, GraphReduce) {
+    Graph g;
+    std::ifstream simple1("tests/inputs/simple1.gr", std::ios::in);
+    g.load(simple1);
+    g.reduce();
+
+    // both terminals end up joined by the direct edge, everything else is gone
+    EXPECT_EQ(4, g.getPreselectedWeight());
+    std::vector<std::pair<int, int>> preselected = {{1, 3}};
+    EXPECT_EQ(preselected, g.getPreselectedEdges());
+    EXPECT_EQ(1u, g.getTerminals().size());
+    EXPECT_EQ(0, g.getEdgeCount());
+
+    // node 2 was contracted into the path towards node 1, node 0 was deleted
+    EXPECT_EQ(1, g.substituteOf(2));
+    EXPECT_EQ(-1, g.substituteOf(0));
+    EXPECT_EQ(1, g.substituteOf(1));
+}
+
 TEST(Structures, TreeDecompositionSimple) {
     TreeDecomposition td;
     std::ifstream simple1("tests/inputs/simple1.td");
@@ -48,3 +104,181 @@ TEST(Structures, TreeDecompositionSimple) {
     EXPECT_EQ(td.getAdjacentTo(2), adj2);
     EXPECT_EQ(td.getAdjacentTo(3), adj3);
 }
+
+TEST(Structures, TreeDecompositionIndex) {
+    Graph g;
+    TreeDecomposition td;
+    std::ifstream simple2("tests/inputs/simple2.grtd");
+    g.load(simple2);
+    td.load(simple2);
+    td.convertToNice(g);
+
+    for (unsigned i = 0; i < td.getNodeCount(); i++) {
+        TreeDecomposition::Node node = td.getNodeAt(i);
+        const TreeDecomposition::NodeIndex &index = node.index;
+
+        for (unsigned pos = 0; pos < node.bag.size(); pos++) {
+            EXPECT_EQ(g.isTerm(node.bag[pos]), (index.termMask & (1u << pos)) != 0);
+        }
+        if (node.type != TreeDecomposition::LEAF) {
+            ASSERT_NE(index.children[0], -1);
+            EXPECT_EQ(index.children[1] != -1, node.type == TreeDecomposition::JOIN);
+        }
+        if (node.type == TreeDecomposition::INTRO) {
+            EXPECT_EQ(node.bag[index.position], node.associatedNode);
+        }
+        if (node.type == TreeDecomposition::FORGET) {
+            EXPECT_EQ(td.getBagOf(index.children[0])[index.position], node.associatedNode);
+        }
+        if (node.type == TreeDecomposition::INTRO_EDGE) {
+            EXPECT_EQ(node.bag[index.edgePositions[0]], node.associatedEdge.first);
+            EXPECT_EQ(node.bag[index.edgePositions[1]], node.associatedEdge.second);
+            EXPECT_EQ((int)index.edgeWeight, g.getEdgeWeight(node.associatedEdge.first, node.associatedEdge.second));
+            EXPECT_EQ(g.edgeWithId(index.edgeId), node.associatedEdge);
+        }
+    }
+}
+
+TEST(Structures, TreeDecompositionImprove) {
+    // cycle 1 - 2 - 3 - 4 - 5 in a single wide bag, with a redundant bag next to it
+    std::istringstream input("SECTION Graph\nNodes 5\nEdges 5\nE 1 2 1\nE 2 3 1\nE 3 4 1\nE 4 5 1\nE 5 1 1\nEND\n"
+                             "SECTION Terminals\nTerminals 2\nT 1\nT 3\nEND\n"
+                             "SECTION Tree Decomposition\ns td 2 5 5\nb 1 1 2 3 4 5\nb 2 1 2\n1 2\nEND\n");
+    Graph g;
+    TreeDecomposition td;
+    g.load(input);
+    td.load(input);
+    td.improve(g, 1.0);
+
+    EXPECT_EQ(3u, td.getWidth());
+    for (int node = 0; node < g.getNodeCount(); node++) {
+        for (unsigned arc = g.arcBegin(node); arc < g.arcEnd(node); arc++) {
+            bool covered = false;
+            for (unsigned i = 0; i < td.getNodeCount(); i++) {
+                ArrayView<int> bag = td.getBagOf(i);
+                covered |= std::count(bag.begin(), bag.end(), node) && std::count(bag.begin(), bag.end(), g.arcTarget(arc));
+            }
+            EXPECT_TRUE(covered);
+        }
+    }
+    EXPECT_EQ(td.getNodeCount() - 1, [&]() {
+        unsigned degrees = 0;
+        for (unsigned i = 0; i < td.getNodeCount(); i++) {
+            degrees += (unsigned)td.getAdjacentTo(i).size();
+        }
+        return degrees / 2;
+    }());
+}
+
+TEST(Structures, Snapshot) {
+    Graph g;
+    TreeDecomposition td;
+    std::ifstream simple2("tests/inputs/simple2.grtd");
+    g.load(simple2);
+    td.load(simple2);
+    td.convertToNice(g);
+
+    const char *path = "snapshot_test.bin";
+    {
+        SnapshotWriter output(path);
+        g.saveSnapshot(output);
+        td.saveSnapshot(output);
+    }
+    Graph loadedGraph;
+    TreeDecomposition loadedTd;
+    {
+        SnapshotReader input(path);
+        loadedGraph.loadSnapshot(input);
+        loadedTd.loadSnapshot(input);
+    }
+    std::remove(path);
+
+    EXPECT_EQ(g.getNodeCount(), loadedGraph.getNodeCount());
+    EXPECT_EQ(g.getTerminals(), loadedGraph.getTerminals());
+    EXPECT_EQ(g.getPreselectedEdges(), loadedGraph.getPreselectedEdges());
+    for (int node = 0; node < g.getNodeCount(); node++) {
+        ASSERT_EQ(g.arcEnd(node), loadedGraph.arcEnd(node));
+        for (unsigned arc = g.arcBegin(node); arc < g.arcEnd(node); arc++) {
+            EXPECT_EQ(g.arcTarget(arc), loadedGraph.arcTarget(arc));
+            EXPECT_EQ(g.arcWeight(arc), loadedGraph.arcWeight(arc));
+            EXPECT_EQ(g.arcEdgeId(arc), loadedGraph.arcEdgeId(arc));
+        }
+    }
+
+    ASSERT_EQ(td.getNodeCount(), loadedTd.getNodeCount());
+    EXPECT_EQ(td.getWidth(), loadedTd.getWidth());
+    for (unsigned i = 0; i < td.getNodeCount(); i++) {
+        EXPECT_EQ(td.getNodeAt(i).type, loadedTd.getNodeAt(i).type);
+        EXPECT_EQ(td.getNodeAt(i).associatedNode, loadedTd.getNodeAt(i).associatedNode);
+        EXPECT_EQ(td.getBagOf(i), loadedTd.getBagOf(i));
+        EXPECT_EQ(td.getAdjacentTo(i), loadedTd.getAdjacentTo(i));
+        EXPECT_EQ(td.getIndexOf(i).position, loadedTd.getIndexOf(i).position);
+        EXPECT_EQ(td.getIndexOf(i).termMask, loadedTd.getIndexOf(i).termMask);
+        EXPECT_EQ(td.getIndexOf(i).edgeId, loadedTd.getIndexOf(i).edgeId);
+    }
+}
+
+TEST(Structures, SnapshotCorruptedLength) {
+    const char *path = "snapshot_corrupted.bin";
+    // huge counts, and one that wraps around when added to the position
+    for (uint64_t count : {1ull << 40u, ~0ull - 7}) {
+        {
+            SnapshotWriter output(path);
+            output.writeArray(std::vector<int>{1, 2, 3});
+            output.writeArray(std::vector<int>{4, 5});
+        }
+        // the first count follows the 16 byte header
+        FILE *file = fopen(path, "r+b");
+        ASSERT_NE(nullptr, file);
+        fseek(file, 16, SEEK_SET);
+        fwrite(&count, sizeof(count), 1, file);
+        fclose(file);
+
+        EXPECT_EXIT({
+            SnapshotReader input(path);
+            std::vector<int> values;
+            input.readArray(values);
+        }, ::testing::ExitedWithCode(1), "Snapshot is truncated");
+    }
+    std::remove(path);
+}
+
+TEST(Structures, SolutionDAG) {
+    SolutionDAG dag;
+    EXPECT_TRUE(dag.collectEdges(SolutionDAG::EMPTY).empty());
+
+    int left = dag.addEdge(SolutionDAG::EMPTY, 0);
+    left = dag.addEdge(left, 3);
+    int right = dag.addEdge(SolutionDAG::EMPTY, 5);
+
+    // joins with an empty branch reuse the other record
+    EXPECT_EQ(left, dag.join(left, SolutionDAG::EMPTY));
+    EXPECT_EQ(right, dag.join(SolutionDAG::EMPTY, right));
+
+    int joined = dag.join(left, right);
+    std::vector<int> edges = dag.collectEdges(joined);
+    std::set<int> edgeSet(edges.begin(), edges.end());
+    std::set<int> refEdges = {0, 3, 5};
+    EXPECT_EQ(refEdges, edgeSet);
+    EXPECT_EQ(3u, edges.size());
+
+    // earlier records stay valid after later appends
+    std::vector<int> leftEdges = dag.collectEdges(left);
+    EXPECT_EQ(2u, leftEdges.size());
+}
+
+TEST(Structures, TreeDecompositionEmpty) {
+    Graph g;
+    std::istringstream graphInput("SECTION Graph\nNodes 1\nEdges 0\nEND\n\n"
+                                  "SECTION Terminals\nTerminals 1\nT 1\nEND\n");
+    g.load(graphInput);
+
+    // without any bag the conversion still roots at an empty leaf
+    TreeDecomposition td;
+    std::istringstream tdInput("SECTION Tree Decomposition\ns td 0 0 1\nEND\n");
+    td.load(tdInput);
+    td.convertToNice(g);
+
+    ASSERT_LT(0u, td.getNodeCount());
+    EXPECT_TRUE(td.getBagOf(0).empty());
+}
@@ -0,0 +1,38 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <vector>
+
+#include "utility/thread_pool.h"
+
+TEST(ThreadPool, ParallelFor) {
+    for (unsigned threads : {1u, 2u, 4u}) {
+        ThreadPool pool(threads);
+        std::vector<std::atomic<int>> visits(1000);
+        for (auto &visit : visits) {
+            visit = 0;
+        }
+        pool.parallelFor(0, 1000, [&](unsigned idx) {
+            visits[idx]++;
+        });
+        for (auto &visit : visits) {
+            EXPECT_EQ(1, visit);
+        }
+    }
+}
+
+TEST(ThreadPool, NestedTasks) {
+    ThreadPool pool(3);
+    std::atomic<unsigned> done(0);
+    // every task spawns a nested parallel loop, the waiting threads have to help out
+    for (unsigned i = 0; i < 8; i++) {
+        pool.submit([&]() {
+            pool.parallelFor(0, 16, [&](unsigned) {
+                done++;
+            });
+        });
+    }
+    pool.waitUntil([&]() {
+        return done == 8 * 16;
+    });
+    EXPECT_EQ(8u * 16u, done);
+}